@@ -0,0 +1,78 @@
+// Dylan Richardson
+// Measures how many times per second a node can evaluate a long expression.
+// Given a number of distinct V, the expression is instead one without I that
+// two nodes share, evaluated for those V in turn through its memo.
+//
+// Usage: expr_eval [operators] [evaluations] [distinct V]
+#include "../common/node.hpp"
+#include "../common/optimize.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <time.h>
+
+using namespace std;
+
+const int DEPENDENCY_TOTAL = 7; // the V of every evaluation
+
+double seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// I V + 3 * 4 - 5 + ... with the given number of operators
+vector<string> longExpression(int operators) {
+    const char* ops[] = { "+", "*", "-", "+", "%" };
+    vector<string> symbols;
+    symbols.push_back("I");
+    for (int i = 0; i < operators; i++) {
+        symbols.push_back(i % 2 ? "V" : to_string(i % 97 + 2));
+        symbols.push_back(ops[i % 5]);
+    }
+    return symbols;
+}
+
+// V 2 + V * 4 - ... I + , everything but the last I shareable
+vector<string> sharedExpression(int operators) {
+    vector<string> symbols = longExpression(operators);
+    symbols[0] = "V";
+    symbols.push_back("I");
+    symbols.push_back("+");
+    return symbols;
+}
+
+int main(int argc, char* argv[]) {
+    int operators = argc > 1 ? atoi(argv[1]) : 1000;
+    int evaluations = argc > 2 ? atoi(argv[2]) : 20000;
+    int totals = argc > 3 ? atoi(argv[3]) : 0;
+    vector<string> symbols = totals > 0 ? sharedExpression(operators) : longExpression(operators);
+    NodeStore nodes;
+    Csr dependencies;
+    for (int id = 0; id < (totals > 0 ? 2 : 1); id++) {
+        Expression expression;
+        if (!compileExpr(symbols, id, "C", expression)) {
+            return 1;
+        }
+        nodes.addNode(id ? "D" : "C", 0, 0, expression);
+        dependencies.endRow();
+    }
+    nodes.build(dependencies);
+    if (totals > 0) {
+        optimizeExpressions(nodes);
+    }
+    long checksum = 0;
+    double start = seconds();
+    for (int i = 0; i < evaluations; i++) {
+        checksum += nodes.getValue(0, totals > 0 ? DEPENDENCY_TOTAL + i % totals : DEPENDENCY_TOTAL);
+    }
+    double elapsed = seconds() - start;
+    cout << "operators " << operators << " evaluations " << evaluations;
+    if (totals > 0) {
+        cout << " distinct V " << totals;
+    }
+    cout << " evals/s " << (long) (evaluations / elapsed)
+         << " checksum " << checksum << "\n";
+    return 0;
+}
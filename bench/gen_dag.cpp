@@ -0,0 +1,163 @@
+// Dylan Richardson
+// Writes a synthetic graph config of a given shape and size to stdout.
+//
+// Usage: gen_dag fanout|chain|diamond|layered|fanin|longexpr|sharedexpr <nodes> [seed]
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+// every node is named n followed by its index
+void printNode(int id, int value, const vector<int> &deps, const char* expression) {
+    printf("n%d %d 0", id, value);
+    for (size_t i = 0, max = deps.size(); i < max; i++) {
+        printf(" n%d", deps[i]);
+    }
+    if (expression) {
+        printf(" = %s", expression);
+    }
+    printf("\n");
+}
+
+// one root that every other node depends on
+void fanout(int count) {
+    printNode(0, 1, vector<int>(), NULL);
+    for (int i = 1; i < count; i++) {
+        printNode(i, 0, vector<int>(1, 0), "V I +");
+    }
+}
+
+// every node depends on the one before it
+void chain(int count) {
+    printNode(0, 1, vector<int>(), NULL);
+    for (int i = 1; i < count; i++) {
+        printNode(i, 0, vector<int>(1, i - 1), "I 7 %");
+    }
+}
+
+// a chain of diamonds, each splitting into two nodes that join again
+void diamond(int count) {
+    printNode(0, 1, vector<int>(), NULL);
+    int top = 0;
+    for (int i = 1; i < count; i += 3) {
+        vector<int> join;
+        for (int j = i; j < i + 2 && j < count; j++) {
+            printNode(j, 0, vector<int>(1, top), "I 2 *");
+            join.push_back(j);
+        }
+        if (i + 2 < count) {
+            printNode(i + 2, 0, join, "V 3 %");
+        }
+        top = i + 2;
+    }
+}
+
+// layers about as wide as they are deep, each node depending on up to
+// three random nodes of the layer above
+void layered(int count, unsigned seed) {
+    mt19937 random(seed);
+    int width = 1;
+    while (width * width < count) {
+        width++;
+    }
+    for (int i = 0; i < count; i++) {
+        vector<int> deps;
+        int layerStart = i - i % width;
+        if (layerStart > 0) {
+            int depCount = random() % 3 + 1;
+            for (int j = 0; j < depCount; j++) {
+                int dep = layerStart - width + random() % width;
+                if (find(deps.begin(), deps.end(), dep) == deps.end()) {
+                    deps.push_back(dep);
+                }
+            }
+        }
+        printNode(i, i % 5, deps, deps.empty() ? NULL : "I V + 11 %");
+    }
+}
+
+// every node but the last is a root that the last depends on
+void fanin(int count) {
+    for (int i = 0; i < count - 1; i++) {
+        printNode(i, i % 3, vector<int>(), NULL);
+    }
+    vector<int> deps;
+    for (int i = 0; i < count - 1; i++) {
+        deps.push_back(i);
+    }
+    printNode(count - 1, 0, deps, "V");
+}
+
+// a fan-out whose nodes evaluate a hundred operators each
+void longexpr(int count) {
+    const char* ops[] = { "+", "*", "-", "+" };
+    string expression = "I";
+    for (int i = 0; i < 100; i++) {
+        expression += i % 2 ? " V " : " " + to_string(i % 97 + 2) + " ";
+        expression += ops[i % 4];
+    }
+    printNode(0, 1, vector<int>(), NULL);
+    for (int i = 1; i < count; i++) {
+        printNode(i, 0, vector<int>(1, 0), expression.c_str());
+    }
+}
+
+// nodes that each depend on two of sixteen roots and share a hundred
+// operators without I, so the optimizer moves them into one shared
+// expression. the nodes one root makes ready see up to sixteen different V.
+void sharedexpr(int count) {
+    const char* ops[] = { "+", "*", "-", "+" };
+    string expression = "V";
+    for (int i = 0; i < 100; i++) {
+        expression += i % 2 ? " V " : " " + to_string(i % 97 + 2) + " ";
+        expression += ops[i % 4];
+    }
+    expression += " I +";
+    int roots = min(count, 16);
+    for (int i = 0; i < roots; i++) {
+        printNode(i, i + 1, vector<int>(), NULL);
+    }
+    for (int i = roots; i < count; i++) {
+        vector<int> deps(1, i % roots);
+        if ((i / roots) % roots != i % roots) {
+            deps.push_back((i / roots) % roots);
+        }
+        printNode(i, 0, deps, expression.c_str());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || atoi(argv[2]) < 1) {
+        cerr << "Usage: " << argv[0]
+             << " fanout|chain|diamond|layered|fanin|longexpr|sharedexpr <nodes> [seed]\n";
+        return 1;
+    }
+    string shape = argv[1];
+    int count = atoi(argv[2]);
+    unsigned seed = argc > 3 ? atoi(argv[3]) : 1;
+    if (shape == "fanout") {
+        fanout(count);
+    } else if (shape == "chain") {
+        chain(count);
+    } else if (shape == "diamond") {
+        diamond(count);
+    } else if (shape == "layered") {
+        layered(count, seed);
+    } else if (shape == "fanin") {
+        fanin(count);
+    } else if (shape == "longexpr") {
+        longexpr(count);
+    } else if (shape == "sharedexpr") {
+        sharedexpr(count);
+    } else {
+        cerr << "Unknown shape '" << shape << "'.\n";
+        return 1;
+    }
+    return 0;
+}
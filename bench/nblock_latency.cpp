@@ -0,0 +1,90 @@
+// Dylan Richardson
+// Measures how long it takes from the signal that releases an nblock until
+// the thread waiting on it wakes up. the signal that releases it posts the
+// semaphore of the round, as the countdowns post the end of a run.
+#include "../nblock/nblock.hpp"
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <stdlib.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <time.h>
+
+using namespace std;
+
+struct Round {
+    int block;
+    sem_t released;
+    atomic<long> signalled; // latest signal time, set before signalling
+};
+
+int ROUNDS = 20000;
+int SIGNALLERS = 1;
+Round* ROUNDS_DATA;
+NBlockTable NBLOCKS;
+atomic<int> STARTED_ROUNDS(0);
+
+long now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// each signaller signals every round once, the last one stamps the time
+void* signaller(void*) {
+    for (int i = 0; i < ROUNDS; i++) {
+        // wait until the waiter has started this round
+        while (STARTED_ROUNDS.load() <= i) {
+            sched_yield();
+        }
+        long stamp = now();
+        long latest = ROUNDS_DATA[i].signalled.load();
+        while (latest < stamp
+                && !ROUNDS_DATA[i].signalled.compare_exchange_weak(latest, stamp)) {
+        }
+        if (NBLOCKS.SignalNBlock(ROUNDS_DATA[i].block)) {
+            sem_post(&ROUNDS_DATA[i].released);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        SIGNALLERS = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        ROUNDS = atoi(argv[2]);
+    }
+    ROUNDS_DATA = new Round[ROUNDS];
+    for (int i = 0; i < ROUNDS; i++) {
+        ROUNDS_DATA[i].block = NBLOCKS.CreateNBlock(SIGNALLERS);
+        sem_init(&ROUNDS_DATA[i].released, 0, 0);
+        ROUNDS_DATA[i].signalled = 0;
+    }
+    vector<pthread_t> threads(SIGNALLERS);
+    for (int i = 0; i < SIGNALLERS; i++) {
+        pthread_create(&threads[i], NULL, signaller, NULL);
+    }
+    vector<long> latencies(ROUNDS);
+    for (int i = 0; i < ROUNDS; i++) {
+        STARTED_ROUNDS.store(i + 1);
+        sem_wait(&ROUNDS_DATA[i].released);
+        latencies[i] = now() - ROUNDS_DATA[i].signalled;
+    }
+    for (int i = 0; i < SIGNALLERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < ROUNDS; i++) {
+        sem_destroy(&ROUNDS_DATA[i].released);
+    }
+    delete[] ROUNDS_DATA;
+    sort(latencies.begin(), latencies.end());
+    cout << "signallers " << SIGNALLERS << " rounds " << ROUNDS
+         << " p50 " << latencies[ROUNDS / 2] << "ns"
+         << " p99 " << latencies[ROUNDS * 99 / 100] << "ns\n";
+    return 0;
+}
@@ -0,0 +1,48 @@
+#!/bin/bash
+# Run a config on more and more processes and print the speedup of each over
+# one process with the edges cut and the bytes the processes exchanged.
+#
+# Usage: bench/processes.sh <config> [max processes] [threads]
+# Processes go up by powers of two from 1 to max processes (default 8), every
+# process running its own pool of threads workers (default 1).
+
+cd "$(dirname "$0")/.."
+
+CONFIG=$1
+MAX_PROCESSES=${2:-8}
+THREADS=${3:-1}
+if [ -z "$CONFIG" ]; then
+    echo "Usage: $0 <config> [max processes] [threads]" >&2
+    exit 1
+fi
+
+make -s -C graph || exit 1
+make -s -C nblock || exit 1
+make -s -C coro || exit 1
+
+# print the value of a field of the --stats line
+function statsField
+{
+    echo "$2" | sed -n "s/.*\"$1\": \([0-9.e+-]*\).*/\1/p"
+}
+
+printf "%-14s %9s %12s %8s %10s %10s %16s\n" \
+    binary processes run_ms speedup cut_edges messages bytes_exchanged
+for binary in graph/graph nblock/nblock coro/coro; do
+    base=""
+    for ((processes = 1; processes <= MAX_PROCESSES; processes *= 2)); do
+        stats=$($binary --stats --output none --threads $THREADS --processes $processes \
+                $CONFIG 2>&1 > /dev/null | tail -1)
+        ms=$(statsField run_ms "$stats")
+        if [ -z "$ms" ]; then
+            echo "$binary failed on $processes processes" >&2
+            continue
+        fi
+        base=${base:-$ms}
+        cut=$(statsField cut_edges "$stats")
+        messages=$(statsField messages "$stats")
+        bytes=$(statsField bytes_exchanged "$stats")
+        printf "%-14s %9d %12.1f %8.2f %10d %10d %16d\n" $binary $processes $ms \
+            $(awk "BEGIN { print $base / $ms }") ${cut:-0} ${messages:-0} ${bytes:-0}
+    done
+done
@@ -0,0 +1,42 @@
+#!/bin/bash
+# Run every generated graph shape through every binary and every backend and
+# print the --stats of each run as a JSON array, so that results can be
+# compared between commits.
+#
+# Usage: bench/run.sh [max nodes] [threads] > results.json
+# Sizes go up by powers of ten from 10 to max nodes (default 100000, at most
+# 10000000). Every node has a zero duration, so run time is scheduling overhead.
+
+cd "$(dirname "$0")/.."
+
+MAX_NODES=${1:-100000}
+THREADS=${2:-$(nproc)}
+SHAPES="fanout chain diamond layered fanin longexpr sharedexpr"
+
+make -s -C bench gen_dag || exit 1
+make -s -C graph || exit 1
+make -s -C nblock || exit 1
+make -s -C coro || exit 1
+
+CONFIG=$(mktemp)
+STATS=$(mktemp)
+trap "rm -f $CONFIG $STATS" EXIT
+
+echo "["
+echo "  {\"commit\": \"$(git rev-parse --short HEAD 2>/dev/null)\", \"date\": \"$(date -u +%FT%TZ)\"}"
+for shape in $SHAPES; do
+    for ((nodes = 10; nodes <= MAX_NODES && nodes <= 10000000; nodes *= 10)); do
+        bench/gen_dag $shape $nodes > $CONFIG
+        for binary in graph/graph nblock/nblock coro/coro; do
+            for backend in shared steal pinned; do
+                if ! $binary --stats --threads $THREADS --scheduler $backend $CONFIG \
+                        > /dev/null 2> $STATS; then
+                    echo "$binary failed on a $shape of $nodes nodes" >&2
+                    continue
+                fi
+                echo "  ,{\"shape\": \"$shape\", \"binary\": \"$binary\", \"stats\": $(tail -1 $STATS)}"
+            done
+        done
+    done
+done
+echo "]"
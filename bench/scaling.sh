@@ -0,0 +1,45 @@
+#!/bin/bash
+# Time each scheduling backend of every binary from 1 to 64 worker threads.
+#
+# Usage: bench/scaling.sh [config] [runs]
+# Without a config a zero-duration fan-out of every available node id is used.
+
+cd "$(dirname "$0")/.."
+
+RUNS=${2:-20}
+
+function wideConfig
+{
+    echo "A 1 0"
+    for id in B C D E F G H I J K L M N O P Q R S T U V W X Y Z; do
+        echo "$id 1 0 A = V I +"
+    done
+}
+
+CONFIG=$1
+if [ -z "$CONFIG" ]; then
+    CONFIG=$(mktemp)
+    wideConfig > $CONFIG
+    trap "rm -f $CONFIG" EXIT
+fi
+
+# print the mean wall time of a run in microseconds
+function timeRuns
+{
+    local start=$(date +%s%N)
+    for ((run = 0; run < RUNS; run++)); do
+        "$@" > /dev/null
+    done
+    local end=$(date +%s%N)
+    echo $(( (end - start) / RUNS / 1000 ))
+}
+
+printf "%-14s %-8s %8s %12s\n" binary backend threads "us/run"
+for binary in graph/graph nblock/nblock coro/coro; do
+    for backend in shared steal pinned; do
+        for threads in 1 2 4 8 16 32 64; do
+            us=$(timeRuns $binary --threads $threads --scheduler $backend $CONFIG)
+            printf "%-14s %-8s %8d %12d\n" $binary $backend $threads $us
+        done
+    done
+done
@@ -0,0 +1,175 @@
+// Dylan Richardson
+// Sends a graph to a server started with --serve from several clients at
+// once and measures how long each request takes until its reply is read.
+//
+// Usage: serve_load <socket> <config|graph.gbin> [clients] [requests per client]
+#include "../common/serve.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std;
+
+int CLIENTS = 1;
+int REQUESTS = 1000;
+string SOCKET_PATH;
+string REQUEST; // the graph every request sends
+vector<long> LATENCIES; // each client fills its own range
+vector<int> FAILURES;
+
+long now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+bool readFully(int fd, void* data, size_t size) {
+    char* at = (char*) data;
+    while (size > 0) {
+        ssize_t length = read(fd, at, size);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length <= 0) {
+            return false;
+        }
+        at += length;
+        size -= length;
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* data, size_t size) {
+    const char* at = (const char*) data;
+    while (size > 0) {
+        ssize_t length = write(fd, at, size);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length < 0) {
+            return false;
+        }
+        at += length;
+        size -= length;
+    }
+    return true;
+}
+
+int connectServer() {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, SOCKET_PATH.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd != -1 && connect(fd, (struct sockaddr*) &address, sizeof(address))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// send one request and skip its output frames up to the reply
+bool request(int fd, ServeReply &reply) {
+    int32_t length = REQUEST.size();
+    if (!writeFully(fd, &length, sizeof(length))
+            || !writeFully(fd, REQUEST.data(), REQUEST.size())) {
+        return false;
+    }
+    vector<char> frame;
+    while (readFully(fd, &length, sizeof(length))) {
+        if (length == 0) {
+            return readFully(fd, &reply, sizeof(reply));
+        }
+        frame.resize(length);
+        if (!readFully(fd, frame.data(), length)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// every client keeps one connection open for all of its requests
+void* client(void* context) {
+    long index = (long) context;
+    int fd = connectServer();
+    if (fd == -1) {
+        cerr << "Could not connect to " << SOCKET_PATH << "\n";
+        FAILURES[index] = REQUESTS;
+        return NULL;
+    }
+    for (int i = 0; i < REQUESTS; i++) {
+        ServeReply reply;
+        long start = now();
+        if (!request(fd, reply)) {
+            FAILURES[index] += REQUESTS - i;
+            break;
+        }
+        LATENCIES[index * REQUESTS + i] = now() - start;
+        if (reply.status != SERVE_OK) {
+            FAILURES[index]++;
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0]
+             << " <socket> <config|graph.gbin> [clients] [requests per client]\n";
+        return 1;
+    }
+    SOCKET_PATH = argv[1];
+    ifstream file(argv[2], ios::binary);
+    if (!file) {
+        cerr << "Could not read " << argv[2] << "\n";
+        return 1;
+    }
+    stringstream contents;
+    contents << file.rdbuf();
+    REQUEST = contents.str();
+    if (argc > 3) {
+        CLIENTS = atoi(argv[3]);
+    }
+    if (argc > 4) {
+        REQUESTS = atoi(argv[4]);
+    }
+    if (REQUEST.empty() || CLIENTS < 1 || REQUESTS < 1) {
+        cerr << "Needs a graph, at least one client and at least one request.\n";
+        return 1;
+    }
+    LATENCIES.assign((long) CLIENTS * REQUESTS, 0);
+    FAILURES.assign(CLIENTS, 0);
+    vector<pthread_t> threads(CLIENTS);
+    long start = now();
+    for (long i = 0; i < CLIENTS; i++) {
+        pthread_create(&threads[i], NULL, client, (void*) i);
+    }
+    for (int i = 0; i < CLIENTS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = (now() - start) / 1e9;
+    int failed = 0;
+    for (int i = 0; i < CLIENTS; i++) {
+        failed += FAILURES[i];
+    }
+    long total = LATENCIES.size();
+    sort(LATENCIES.begin(), LATENCIES.end());
+    cout << "clients " << CLIENTS << " requests " << total << " failed " << failed
+         << " rps " << (long) (total / elapsed)
+         << " p50 " << LATENCIES[total / 2] << "ns"
+         << " p99 " << LATENCIES[total * 99 / 100] << "ns\n";
+    return failed ? 1 : 0;
+}
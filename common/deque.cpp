@@ -0,0 +1,95 @@
+// Dylan Richardson
+#include "deque.hpp"
+
+using namespace std;
+
+const long INITIAL_CAPACITY = 64;
+
+WorkDeque::Buffer::Buffer(long capacity) {
+    this->capacity = capacity;
+    this->slots = new Slot[capacity];
+}
+
+WorkDeque::Buffer::~Buffer() {
+    delete[] slots;
+}
+
+void WorkDeque::Buffer::put(long i, Noduler noduler) {
+    Slot &slot = slots[i & (capacity - 1)];
+    slot.scheduler.store(noduler.scheduler, memory_order_relaxed);
+    slot.node.store(noduler.node, memory_order_relaxed);
+}
+
+Noduler WorkDeque::Buffer::get(long i) {
+    Slot &slot = slots[i & (capacity - 1)];
+    return Noduler(slot.scheduler.load(memory_order_relaxed),
+                   slot.node.load(memory_order_relaxed));
+}
+
+WorkDeque::WorkDeque() : top(0), bottom(0) {
+    buffer.store(new Buffer(INITIAL_CAPACITY), memory_order_relaxed);
+}
+
+WorkDeque::~WorkDeque() {
+    delete buffer.load(memory_order_relaxed);
+    for (size_t i = 0, max = retired.size(); i < max; i++) {
+        delete retired[i];
+    }
+}
+
+void WorkDeque::push(Noduler noduler) {
+    long b = bottom.load(memory_order_relaxed);
+    long t = top.load(memory_order_acquire);
+    Buffer* a = buffer.load(memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+        a = grow(a, t, b);
+    }
+    a->put(b, noduler);
+    atomic_thread_fence(memory_order_release);
+    bottom.store(b + 1, memory_order_relaxed);
+}
+
+bool WorkDeque::pop(Noduler &noduler) {
+    long b = bottom.load(memory_order_relaxed) - 1;
+    Buffer* a = buffer.load(memory_order_relaxed);
+    bottom.store(b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = top.load(memory_order_relaxed);
+    if (t > b) {
+        // empty
+        bottom.store(b + 1, memory_order_relaxed);
+        return false;
+    }
+    noduler = a->get(b);
+    if (t == b) {
+        // last element, race the thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1,
+                        memory_order_seq_cst, memory_order_relaxed);
+        bottom.store(b + 1, memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+bool WorkDeque::steal(Noduler &noduler) {
+    long t = top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = bottom.load(memory_order_acquire);
+    if (t >= b) {
+        return false;
+    }
+    Buffer* a = buffer.load(memory_order_acquire);
+    noduler = a->get(t);
+    return top.compare_exchange_strong(t, t + 1,
+                memory_order_seq_cst, memory_order_relaxed);
+}
+
+WorkDeque::Buffer* WorkDeque::grow(Buffer* old, long t, long b) {
+    Buffer* a = new Buffer(old->capacity * 2);
+    for (long i = t; i < b; i++) {
+        a->put(i, old->get(i));
+    }
+    buffer.store(a, memory_order_release);
+    retired.push_back(old);
+    return a;
+}
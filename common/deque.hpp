@@ -0,0 +1,39 @@
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include "pool.hpp"
+#include <atomic>
+#include <vector>
+
+// Chase-Lev work-stealing deque. The owning worker pushes and pops at the
+// bottom while any other worker may steal from the top.
+class WorkDeque {
+    public:
+        WorkDeque();
+        ~WorkDeque();
+        void push(Noduler);
+        bool pop(Noduler &noduler);
+        bool steal(Noduler &noduler);
+    private:
+        struct Slot {
+            std::atomic<Scheduler*> scheduler;
+            std::atomic<int> node;
+        };
+        struct Buffer {
+            long capacity;
+            Slot* slots;
+            Buffer(long);
+            ~Buffer();
+            void put(long, Noduler);
+            Noduler get(long);
+        };
+
+        alignas(64) std::atomic<long> top;
+        alignas(64) std::atomic<long> bottom;
+        std::atomic<Buffer*> buffer;
+        std::vector<Buffer*> retired; // grown out buffers a thief may still read
+
+        Buffer* grow(Buffer*, long, long);
+};
+
+#endif
@@ -0,0 +1,196 @@
+// Dylan Richardson
+#include "gbin.hpp"
+#include "node.hpp"
+#include "scheduler.hpp"
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// where the arena and the order lie in a compiled graph
+struct GbinView {
+    const GbinHeader* header;
+    StoreSizes sizes;
+    size_t arenaSize;
+    const int32_t* topologicalOrder;
+};
+
+bool isGbinFile(string fileName) {
+    char magic[sizeof(GBIN_MAGIC)];
+    ifstream file(fileName.c_str(), ios::binary);
+    return file.read(magic, sizeof(magic)) && !memcmp(magic, GBIN_MAGIC, sizeof(magic));
+}
+
+bool isGbin(const char* data, size_t size) {
+    return size >= sizeof(GBIN_MAGIC) && !memcmp(data, GBIN_MAGIC, sizeof(GBIN_MAGIC));
+}
+
+bool writeGbin(string fileName, Scheduler* scheduler) {
+    const NodeStore &nodes = scheduler->getNodes();
+    StoreSizes sizes = nodes.getSizes();
+    Span<char> arena = nodes.getImage();
+    const vector<NodeId> &order = scheduler->getTopologicalOrder();
+    GbinHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GBIN_MAGIC, sizeof(GBIN_MAGIC));
+    header.version = GBIN_VERSION;
+    header.nodeCount = sizes.nodeCount;
+    header.edgeCount = sizes.edgeCount;
+    header.codeCount = sizes.codeCount;
+    header.namesSize = sizes.namesSize;
+    char padding[CACHE_LINE] = {};
+
+    ofstream file(fileName.c_str(), ios::binary);
+    file.write((const char*) &header, sizeof(header));
+    file.write(arena.data(), arena.size());
+    file.write(padding, (CACHE_LINE - arena.size() % CACHE_LINE) % CACHE_LINE);
+    file.write((const char*) order.data(), order.size() * sizeof(int32_t));
+    if (!file) {
+        cerr << "Could not write the compiled graph: " << fileName << "\n";
+        return false;
+    }
+    return true;
+}
+
+// find the arena and the order in the data and make sure they fit in it,
+// the arena is checked against the counts once it is laid out
+bool viewGbin(const char* data, size_t size, GbinView &view) {
+    view.header = (const GbinHeader*) data;
+    const GbinHeader &header = *view.header;
+    if (size < sizeof(GbinHeader) || memcmp(header.magic, GBIN_MAGIC, sizeof(GBIN_MAGIC))) {
+        cerr << "The compiled graph is not a gbin file.\n";
+        return false;
+    }
+    if (header.version != GBIN_VERSION) {
+        cerr << "The compiled graph is version " << header.version
+             << " but version " << GBIN_VERSION << " is required.\n";
+        return false;
+    }
+    size_t orderSize = (size_t) header.nodeCount * sizeof(int32_t);
+    if (header.nodeCount < 1 || size - sizeof(GbinHeader) < orderSize) {
+        cerr << "The compiled graph is truncated or corrupt.\n";
+        return false;
+    }
+    view.sizes.nodeCount = header.nodeCount;
+    view.sizes.edgeCount = header.edgeCount;
+    view.sizes.codeCount = header.codeCount;
+    view.sizes.namesSize = header.namesSize;
+    view.arenaSize = size - sizeof(GbinHeader) - orderSize;
+    view.topologicalOrder = (const int32_t*) (data + size - orderSize);
+    return true;
+}
+
+// the saved order and next nodes are only trusted when they agree with the
+// dependencies: every node once and after its dependencies, the total
+// durations of that order, and the next nodes exactly the transpose of the
+// dependencies, row by row in the order transpose builds them
+bool consistentOrder(const NodeStore &nodes, const int32_t* order) {
+    int nodeCount = nodes.size();
+    vector<int> position(nodeCount, -1);
+    for (int i = 0; i < nodeCount; i++) {
+        if (order[i] < 0 || order[i] >= nodeCount || position[order[i]] != -1) {
+            return false;
+        }
+        position[order[i]] = i;
+    }
+    // the next node of each row that the next dependency on it must match
+    vector<int> cursors(nodeCount, 0);
+    for (NodeId id = 0; id < nodeCount; id++) {
+        int maxDur = 0;
+        for (NodeId dep : nodes.getDependencies(id)) {
+            Span<NodeId> nextNodes = nodes.getNextNodes(dep);
+            if (position[dep] >= position[id] || cursors[dep] == (int) nextNodes.size()
+                    || nextNodes[cursors[dep]] != id) {
+                return false;
+            }
+            cursors[dep]++;
+            maxDur = std::max(maxDur, nodes.getTotalDuration(dep));
+        }
+        if (nodes.getTotalDuration(id) != nodes.getDuration(id) + maxDur) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// a scheduler for the graph laid out in the store. a file that is in range
+// but whose order or next nodes do not agree with its dependencies is sorted
+// again like a parsed config, so the caller checks that it is acyclic.
+Scheduler* schedulerFromImage(const GbinView &view, NodeStore* nodes, int threadCount,
+                              PoolBackend backend) {
+    const char* error = nodes->checkImage();
+    if (error) {
+        cerr << "The compiled graph " << error << ".\n";
+        return NULL;
+    }
+    if (!consistentOrder(*nodes, view.topologicalOrder)) {
+        nodes->rebuildNextNodes();
+        return new Scheduler(nodes, threadCount, backend);
+    }
+    int nodeCount = nodes->size();
+    return new Scheduler(nodes,
+                         vector<NodeId>(view.topologicalOrder, view.topologicalOrder + nodeCount),
+                         threadCount, backend);
+}
+
+// the store lies in the mapping of the file, which is private so that
+// values and expressions can still change without writing to the file
+Scheduler* readGbin(string fileName, int threadCount, PoolBackend backend) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info) || info.st_size == 0) {
+        cerr << "Could not read the compiled graph: " << fileName << "\n";
+        if (fd != -1) {
+            close(fd);
+        }
+        return NULL;
+    }
+    void* data = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        cerr << "Could not map the compiled graph: " << fileName << "\n";
+        return NULL;
+    }
+    GbinView view;
+    NodeStore* nodes = new NodeStore();
+    if (!viewGbin((const char*) data, info.st_size, view)) {
+        munmap(data, info.st_size);
+        delete nodes;
+        return NULL;
+    }
+    if (!nodes->mapImage((char*) data + sizeof(GbinHeader), view.arenaSize, view.sizes, data,
+                         info.st_size)) {
+        cerr << "The compiled graph is truncated or corrupt.\n";
+        munmap(data, info.st_size);
+        delete nodes;
+        return NULL;
+    }
+    Scheduler* scheduler = schedulerFromImage(view, nodes, threadCount, backend);
+    if (!scheduler) {
+        delete nodes;
+    }
+    return scheduler;
+}
+
+// a compiled graph already in memory, copied into the arena of the given
+// empty store
+Scheduler* readGbin(const char* data, size_t size, NodeStore* nodes, int threadCount,
+                    PoolBackend backend) {
+    GbinView view;
+    if (!viewGbin(data, size, view)) {
+        return NULL;
+    }
+    if (!nodes->copyImage(data + sizeof(GbinHeader), view.arenaSize, view.sizes)) {
+        cerr << "The compiled graph is truncated or corrupt.\n";
+        return NULL;
+    }
+    return schedulerFromImage(view, nodes, threadCount, backend);
+}
@@ -0,0 +1,41 @@
+#ifndef GBIN_H
+#define GBIN_H
+
+#include "node.hpp"
+#include "scheduler.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// a validated graph saved so that it can be mapped and run without parsing
+// or building. the file holds the arena of the node store as it is laid
+// out in memory, so a mapped file is the store itself. the file is
+//
+//     GbinHeader    padded to a cache line, so the arena starts one
+//     char          arena[]          the NodeStore arena, its code pool full
+//     int32_t       topologicalOrder[nodeCount]
+//
+// where the size of the arena follows from the counts in the header. it is
+// in native byte order and laid out for the int and Instruction of the
+// machine that wrote it.
+
+const char GBIN_MAGIC[4] = { 'G', 'B', 'I', 'N' };
+const int32_t GBIN_VERSION = 3;
+
+struct GbinHeader {
+    char magic[4];
+    int32_t version;
+    int32_t nodeCount;
+    int32_t edgeCount;
+    int32_t codeCount;
+    int32_t namesSize;
+    char padding[CACHE_LINE - 6 * sizeof(int32_t)];
+};
+
+bool isGbinFile(std::string);
+bool isGbin(const char*, size_t);
+bool writeGbin(std::string, Scheduler*);
+Scheduler* readGbin(std::string, int, PoolBackend);
+Scheduler* readGbin(const char*, size_t, NodeStore*, int, PoolBackend);
+
+#endif
@@ -0,0 +1,726 @@
+// Dylan Richardson
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <map>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include "scheduler.hpp"
+#include "node.hpp"
+#include "pool.hpp"
+#include "parser.hpp"
+#include "gbin.hpp"
+#include "trace.hpp"
+#include "optimize.hpp"
+#include "output.hpp"
+#include "serve.hpp"
+#include "partition.hpp"
+
+using namespace std;
+
+struct Options {
+    string fileName;
+    vector<string> batchFiles;
+    int threads;
+    int processes;
+    PoolBackend backend;
+    QueuePolicy policy;
+    bool report;
+    bool interactive;
+    bool watch;
+    bool optimize;
+    bool fuse;
+    OutputFormat output;
+    string scenariosFile;
+    string scenarioOutFile;
+    string vectorsFile;
+    string compileFile;
+    bool simulate;
+    bool stats;
+    string traceFile;
+    bool batch;
+    string servePath;
+};
+
+bool parseArgs(int, char*[], Options &options);
+bool parseThreads(string, Options &options);
+bool parseProcesses(string, Options &options);
+bool parseBackend(string, Options &options);
+bool parsePolicy(string, Options &options);
+bool parseOutput(string, Options &options);
+void printUsage(char*);
+Scheduler* parseConfig(Options);
+bool validateNodeId(string);
+bool validateValue(string);
+vector<string> split(const string &s, char);
+bool runScenarios(Scheduler*, Options);
+bool loadVectors(Scheduler*, Options);
+bool runBatch(Options);
+bool parseScenarios(ifstream &file, Scenarios &scenarios);
+bool writeScenarioResults(string, vector<GraphResult>);
+double seconds();
+void printStats(Options, size_t, double, double, const PartitionStats &partition);
+void printReport(Scheduler*, Options, int);
+void runInteractive(Scheduler*);
+bool applyEdit(Scheduler*, const map<string, NodeId> &ids, const vector<string> &words);
+Scheduler* runWatch(Scheduler*, Options);
+Scheduler* reloadConfig(Scheduler*, Options);
+void configureScheduler(Scheduler*, Options);
+bool sameStructure(Scheduler*, const NodeStore &nodes);
+
+// run the program
+int main(int argc, char* argv[]) {
+    // get the command line options
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage(argv[0]);
+        exit(1);
+    }
+    // answer the graphs sent to a socket until the server is stopped
+    if (options.servePath != "") {
+        return runServer(options.servePath, options.threads, options.backend, options.policy,
+                         options.output, options.optimize) ? 0 : 1;
+    }
+    // run many configs at once instead of one
+    if (options.batch) {
+        return runBatch(options) ? 0 : 1;
+    }
+    // parse the config file
+    Scheduler* scheduler;
+    double parseStart = seconds();
+    if (!(scheduler = parseConfig(options))) {
+        cout << "The configuration file could not be parsed.\n";
+        exit(1);
+    }
+    // save the validated graph instead of running it
+    if (options.compileFile != "") {
+        bool compiled = writeGbin(options.compileFile, scheduler);
+        if (compiled) {
+            cout << "Compiled " << scheduler->getNodes().size() << " nodes into "
+                 << options.compileFile << ".\n";
+        }
+        delete scheduler;
+        return compiled ? 0 : 1;
+    }
+    if (options.optimize) {
+        optimizeExpressions(scheduler->getNodes());
+    }
+    // evaluate scenarios instead of running the graph
+    if (options.scenariosFile != "") {
+        bool ran = runScenarios(scheduler, options);
+        delete scheduler;
+        return ran ? 0 : 1;
+    }
+    // give every node a vector of values instead of one
+    if (options.vectorsFile != "" && !loadVectors(scheduler, options)) {
+        delete scheduler;
+        return 1;
+    }
+    // run the scheduler
+    configureScheduler(scheduler, options);
+    double runStart = seconds();
+    GraphResult result;
+    PartitionStats partition = { 0, 0, 0, 0 };
+    if (options.processes > 1) {
+        if (!runPartitioned(scheduler, options.processes, options.output, result, partition)) {
+            delete scheduler;
+            return 1;
+        }
+    } else {
+        result = options.simulate ? scheduler->simulate() : scheduler->run();
+    }
+    double runEnd = seconds();
+    scheduler->printResult(result);
+    if (options.report) {
+        // a real run sleeps whole seconds, so its wall time rounds to the makespan
+        printReport(scheduler, options, options.simulate ? result.duration
+                                                         : (int) (runEnd - runStart + 0.5));
+    }
+    if (options.stats) {
+        printStats(options, scheduler->getNodes().size(), runStart - parseStart, runEnd - runStart,
+                   partition);
+    }
+    if (options.traceFile != "" && writeTrace(options.traceFile, scheduler->getNodes())) {
+        cout << "Wrote the trace to " << options.traceFile << ".\n";
+    }
+    // keep the graph in memory and recompute what each edit changes
+    if (options.interactive) {
+        runInteractive(scheduler);
+    } else if (options.watch) {
+        scheduler = runWatch(scheduler, options);
+    }
+    // delete the scheduler
+    delete scheduler;
+    return 0;
+}
+
+bool parseArgs(int argc, char* argv[], Options &options) {
+    options.fileName = "";
+    options.threads = defaultThreadCount();
+    options.processes = 1;
+    options.backend = POOL_SHARED;
+    options.policy = POLICY_FIFO;
+    options.report = false;
+    options.interactive = false;
+    options.watch = false;
+    options.optimize = true;
+    options.fuse = true;
+    options.output = OUTPUT_TEXT;
+    options.scenariosFile = "";
+    options.scenarioOutFile = "";
+    options.vectorsFile = "";
+    options.compileFile = "";
+    options.simulate = false;
+    options.stats = false;
+    options.traceFile = "";
+    options.batch = false;
+    options.servePath = "";
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            if (!parseThreads(argv[++i], options)) {
+                return false;
+            }
+        } else if (arg == "--processes" && i + 1 < argc) {
+            if (!parseProcesses(argv[++i], options)) {
+                return false;
+            }
+        } else if (arg == "--scheduler" && i + 1 < argc) {
+            if (!parseBackend(argv[++i], options)) {
+                return false;
+            }
+        } else if (arg == "--policy" && i + 1 < argc) {
+            if (!parsePolicy(argv[++i], options)) {
+                return false;
+            }
+        } else if (arg == "--report") {
+            options.report = true;
+        } else if (arg == "--interactive") {
+            options.interactive = true;
+        } else if (arg == "--watch") {
+            options.watch = true;
+        } else if (arg == "--output" && i + 1 < argc) {
+            if (!parseOutput(argv[++i], options)) {
+                return false;
+            }
+        } else if (arg == "--no-optimize") {
+            options.optimize = false;
+        } else if (arg == "--no-fuse") {
+            options.fuse = false;
+        } else if (arg == "--scenarios" && i + 1 < argc) {
+            options.scenariosFile = argv[++i];
+        } else if (arg == "--scenario-out" && i + 1 < argc) {
+            options.scenarioOutFile = argv[++i];
+        } else if (arg == "--vectors" && i + 1 < argc) {
+            options.vectorsFile = argv[++i];
+        } else if (arg == "--compile" && i + 1 < argc) {
+            options.compileFile = argv[++i];
+        } else if (arg == "--simulate") {
+            options.simulate = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            options.traceFile = argv[++i];
+        } else if (arg == "--batch") {
+            options.batch = true;
+        } else if (arg == "--serve" && i + 1 < argc) {
+            options.servePath = argv[++i];
+        } else if (arg.compare(0, 2, "--") != 0) {
+            files.push_back(arg);
+        } else {
+            cerr << "Unexpected argument '" << arg << "'.\n";
+            return false;
+        }
+    }
+    bool serve = options.servePath != "";
+    if (serve ? !files.empty() : options.batch ? files.empty() : files.size() != 1) {
+        cerr << "Wrong number of arguments.\n";
+        return false;
+    }
+    options.fileName = files.empty() ? "" : files[0];
+    options.batchFiles = files;
+    if (serve && (options.batch || options.interactive || options.watch || options.simulate
+            || options.report || options.stats || options.traceFile != ""
+            || options.scenariosFile != "" || options.compileFile != "")) {
+        cerr << "--serve only runs the graphs it is sent, without --batch, --interactive,"
+             << " --watch, --simulate, --report, --stats, --trace, --scenarios or --compile.\n";
+        return false;
+    }
+    if (options.batch && (options.interactive || options.watch || options.simulate
+            || options.report || options.stats || options.traceFile != ""
+            || options.scenariosFile != "" || options.compileFile != "")) {
+        cerr << "--batch only runs the graphs, without --interactive, --watch, --simulate,"
+             << " --report, --stats, --trace, --scenarios or --compile.\n";
+        return false;
+    }
+    if (options.processes > 1 && (serve || options.batch || options.interactive || options.watch
+            || options.simulate || options.report || options.traceFile != ""
+            || options.scenariosFile != "" || options.compileFile != "")) {
+        cerr << "--processes only runs the graph, without --serve, --batch, --interactive,"
+             << " --watch, --simulate, --report, --trace, --scenarios or --compile.\n";
+        return false;
+    }
+    if (options.vectorsFile != "" && (serve || options.batch || options.processes > 1
+            || options.interactive || options.watch || options.simulate
+            || options.scenariosFile != "" || options.compileFile != "")) {
+        cerr << "--vectors only runs the graph, without --serve, --batch, --processes,"
+             << " --interactive, --watch, --simulate, --scenarios or --compile.\n";
+        return false;
+    }
+    if ((options.scenariosFile == "") != (options.scenarioOutFile == "")) {
+        cerr << "--scenarios and --scenario-out must be given together.\n";
+        return false;
+    }
+    if (options.policy != POLICY_FIFO && options.backend == POOL_STEAL) {
+        cerr << "--policy orders the shared queue, steal orders its own deques.\n";
+        return false;
+    }
+    if (options.interactive && options.watch) {
+        cerr << "--interactive and --watch cannot be used together.\n";
+        return false;
+    }
+    if (options.traceFile != "" && !traceCompiledIn()) {
+        cerr << "--trace needs a build with tracing, run make TRACE=1.\n";
+        return false;
+    }
+    return true;
+}
+
+bool parseThreads(string threads, Options &options) {
+    if (!isInteger(threads) || atoi(threads.c_str()) < 1) {
+        cerr << "Threads '" << threads << "' must be a positive integer.\n";
+        return false;
+    }
+    options.threads = atoi(threads.c_str());
+    return true;
+}
+
+bool parseProcesses(string processes, Options &options) {
+    if (!isInteger(processes) || atoi(processes.c_str()) < 1) {
+        cerr << "Processes '" << processes << "' must be a positive integer.\n";
+        return false;
+    }
+    options.processes = atoi(processes.c_str());
+    return true;
+}
+
+bool parseBackend(string backend, Options &options) {
+    if (!backendFromString(backend, options.backend)) {
+        cerr << "Scheduler '" << backend << "' must be shared, steal or pinned.\n";
+        return false;
+    }
+    return true;
+}
+
+bool parsePolicy(string policy, Options &options) {
+    if (!policyFromString(policy, options.policy)) {
+        cerr << "Policy '" << policy << "' must be fifo, lifo or critical.\n";
+        return false;
+    }
+    return true;
+}
+
+bool parseOutput(string output, Options &options) {
+    if (!outputFromString(output, options.output)) {
+        cerr << "Output '" << output << "' must be text, csv, binary or none.\n";
+        return false;
+    }
+    return true;
+}
+
+void printUsage(char* program) {
+    cerr << "Usage: " << program
+         << " [--threads N] [--processes K] [--scheduler shared|steal|pinned] [--policy fifo|lifo|critical]"
+         << " [--report] [--simulate] [--interactive|--watch] [--no-optimize] [--no-fuse] [--output text|csv|binary|none] [--stats] [--trace trace.json]"
+         << " [--scenarios values --scenario-out results] [--vectors values]"
+         << " [--compile graph.gbin] <config|graph.gbin>\n"
+         << "       " << program << " [--threads N] [--scheduler shared|steal|pinned]"
+         << " [--policy fifo|lifo|critical] [--no-optimize] --batch <config|graph.gbin>...\n"
+         << "       " << program << " [--threads N] [--scheduler shared|steal|pinned]"
+         << " [--policy fifo|lifo|critical] [--no-optimize] [--output text|csv|binary|none]"
+         << " --serve socket\n";
+}
+
+// parse the configuration file and set up a scheduler for its graph.
+// a compiled graph is mapped and checked when it is mapped: ids and sizes
+// must lie in range, and its saved order is only used when it agrees with
+// the dependencies.
+Scheduler* parseConfig(Options options) {
+    Scheduler* scheduler;
+    if (isGbinFile(options.fileName)) {
+        scheduler = readGbin(options.fileName, options.threads, options.backend);
+        if (!scheduler) {
+            return NULL;
+        }
+    } else {
+        NodeStore* nodes = new NodeStore();
+        ConfigParser parser(options.fileName);
+        if (!parser.parse(*nodes)) {
+            delete nodes;
+            return NULL;
+        }
+        scheduler = new Scheduler(nodes, options.threads, options.backend);
+    }
+    // a compiled graph is sorted again when its order can not be trusted
+    if (!scheduler->isAcyclic()) {
+        cerr << "The dependencies of the configuration file form a cycle.\n";
+        delete scheduler;
+        return NULL;
+    }
+    return scheduler;
+}
+
+bool validateNodeId(string node) {
+    if (!isNodeName(node)) {
+        cerr << "Node '" << node << "' must be a name of letters, digits and underscores.\n";
+        return false;
+    }
+    return true;
+}
+
+bool validateValue(string value) {
+    if (!isInteger(value)) {
+        cerr << "Value '" << value << "' must be an integer.\n";
+        return false;
+    }
+    return true;
+}
+
+// split a string by delimiter.
+vector<string> split(const string &s, char delim) {
+    // store the strings in a vector
+    vector<string> elems;
+    // create a stream of the string to read from
+    stringstream ss(s);
+    // token string
+    string item;
+    // read until the delimiter or end of file
+    while (getline(ss, item, delim)) {
+        // append the character to the vector
+        if (!item.empty()) {
+            elems.push_back(item);
+        }
+    }
+    // return the vector of characters
+    return elems;
+}
+
+// run every config of the batch at the same time on one worker pool, which
+// the schedulers share since each ready node carries its scheduler. only
+// the total of each graph is printed, followed by the throughput.
+bool runBatch(Options options) {
+    vector<Scheduler*> schedulers;
+    vector<string> names;
+    bool parsed = true;
+    double start = seconds();
+    for (size_t i = 0, max = options.batchFiles.size(); i < max; i++) {
+        options.fileName = options.batchFiles[i];
+        Scheduler* scheduler = parseConfig(options);
+        if (!scheduler) {
+            cout << "The configuration file " << options.fileName << " could not be parsed.\n";
+            parsed = false;
+            continue;
+        }
+        if (options.optimize) {
+            optimizeExpressions(scheduler->getNodes());
+        }
+        configureScheduler(scheduler, options);
+        scheduler->setOutputFormat(OUTPUT_NONE);
+        schedulers.push_back(scheduler);
+        names.push_back(options.fileName);
+    }
+    WorkerPool pool(options.threads, options.backend, options.policy);
+    for (size_t i = 0, max = schedulers.size(); i < max; i++) {
+        schedulers[i]->start(&pool);
+    }
+    for (size_t i = 0, max = schedulers.size(); i < max; i++) {
+        GraphResult result = schedulers[i]->wait();
+        cout << names[i] << ": Total computation resulted in a value of " << result.value
+             << " after " << durationSeconds(result.duration) << ".\n";
+        delete schedulers[i];
+    }
+    double elapsed = seconds() - start;
+    cout << "Ran " << schedulers.size() << " graphs in " << elapsed << " seconds, "
+         << schedulers.size() / elapsed << " graphs per second.\n";
+    return parsed;
+}
+
+// evaluate the graph once for every scenario in the values file
+bool runScenarios(Scheduler* scheduler, Options options) {
+    ifstream file(options.scenariosFile.c_str());
+    if (!file) {
+        cerr << "Could not find the scenarios file: " << options.scenariosFile << "\n";
+        return false;
+    }
+    Scenarios scenarios;
+    vector<GraphResult> results;
+    if (!parseScenarios(file, scenarios)
+            || !scheduler->runScenarios(scenarios, results)
+            || !writeScenarioResults(options.scenarioOutFile, results)) {
+        return false;
+    }
+    cout << "Computed " << results.size() << " scenarios into "
+         << options.scenarioOutFile << ".\n";
+    return true;
+}
+
+// the vectors file has the layout of a scenarios file, a line for each node
+// followed by its values
+bool loadVectors(Scheduler* scheduler, Options options) {
+    ifstream file(options.vectorsFile.c_str());
+    if (!file) {
+        cerr << "Could not find the vectors file: " << options.vectorsFile << "\n";
+        return false;
+    }
+    Scenarios columns;
+    return parseScenarios(file, columns) && scheduler->setVectors(columns);
+}
+
+// every line is a node id followed by its value in each scenario
+bool parseScenarios(ifstream &file, Scenarios &scenarios) {
+    string line;
+    scenarios.count = -1;
+    while (getline(file, line)) {
+        vector<string> symbols = split(line, ' ');
+        if (symbols.empty()) {
+            continue;
+        }
+        if (!validateNodeId(symbols[0])) {
+            return false;
+        }
+        vector<int> &column = scenarios.columns[symbols[0]];
+        for (size_t i = 1, max = symbols.size(); i < max; i++) {
+            if (!validateValue(symbols[i])) {
+                return false;
+            }
+            column.push_back(strToInt(symbols[i]));
+        }
+        if (scenarios.count != -1 && scenarios.count != (int) column.size()) {
+            cerr << "Node " << symbols[0] << " has " << column.size()
+                 << " scenario values instead of " << scenarios.count << ".\n";
+            return false;
+        }
+        scenarios.count = column.size();
+    }
+    if (scenarios.count < 1) {
+        cerr << "The scenarios file has no values.\n";
+        return false;
+    }
+    return true;
+}
+
+// results are a "GRES" tag, a version and a count followed by the value
+// and duration of each scenario, all as native 32 bit integers
+bool writeScenarioResults(string fileName, vector<GraphResult> results) {
+    ofstream file(fileName.c_str(), ios::binary);
+    int header[] = { 0x53455247, 1, (int) results.size() };
+    file.write((const char*) header, sizeof(header));
+    for (size_t i = 0, max = results.size(); i < max; i++) {
+        int record[] = { results[i].value, results[i].duration };
+        file.write((const char*) record, sizeof(record));
+    }
+    if (!file) {
+        cerr << "Could not write the scenario results: " << fileName << "\n";
+        return false;
+    }
+    return true;
+}
+
+// compare the time the run took with the best any schedule could do
+void printReport(Scheduler* scheduler, Options options, int makespan) {
+    int bound = scheduler->getLowerBound();
+    cout << "Makespan of " << durationSeconds(makespan) << " on " << options.threads
+         << " workers against a lower bound of " << durationSeconds(bound);
+    if (bound > 0) {
+        cout << " (" << (makespan * 100 + bound / 2) / bound << "%)";
+    }
+    cout << ".\n";
+}
+
+double seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// one line of JSON on stderr so that it survives discarding the node output
+void printStats(Options options, size_t nodeCount, double parseTime, double runTime,
+                const PartitionStats &partition) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cerr << "{\"nodes\": " << nodeCount
+         << ", \"threads\": " << options.threads
+         << ", \"processes\": " << options.processes
+         << ", \"backend\": \"" << (options.backend == POOL_STEAL ? "steal"
+                                      : options.backend == POOL_PINNED ? "pinned" : "shared") << "\""
+         << ", \"simulate\": " << (options.simulate ? "true" : "false")
+         << ", \"parse_ms\": " << parseTime * 1e3
+         << ", \"run_ms\": " << runTime * 1e3
+         << ", \"ns_per_node\": " << runTime * 1e9 / nodeCount;
+    if (options.processes > 1) {
+        cerr << ", \"edges\": " << partition.edges
+             << ", \"cut_edges\": " << partition.cutEdges
+             << ", \"messages\": " << partition.messages
+             << ", \"bytes_exchanged\": " << partition.bytes;
+    }
+    cerr << ", \"peak_rss_kb\": " << usage.ru_maxrss << "}\n";
+}
+
+// apply edits read from stdin to the graph in memory and recompute only the
+// nodes downstream of each one, until the input ends or says quit
+void runInteractive(Scheduler* scheduler) {
+    map<string, NodeId> ids;
+    const NodeStore &nodes = scheduler->getNodes();
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        ids[string(nodes.getName(i))] = i;
+    }
+    string line;
+    while (getline(cin, line)) {
+        vector<string> words = split(line, ' ');
+        if (words.empty()) {
+            continue;
+        }
+        if (words[0] == "quit") {
+            break;
+        }
+        if (applyEdit(scheduler, ids, words)) {
+            scheduler->printResult(scheduler->recompute());
+            cout.flush();
+        }
+    }
+}
+
+// an edit is set <node> value <integer> or set <node> expr <expression>,
+// where an empty expression makes the node use its value again
+bool applyEdit(Scheduler* scheduler, const map<string, NodeId> &ids, const vector<string> &words) {
+    if (words.size() < 3 || words[0] != "set" || (words[2] != "value" && words[2] != "expr")) {
+        cerr << "An edit must be 'set <node> value <integer>' or 'set <node> expr <expression>'.\n";
+        return false;
+    }
+    map<string, NodeId>::const_iterator id = ids.find(words[1]);
+    if (id == ids.end()) {
+        cerr << "Node '" << words[1] << "' is not in the graph.\n";
+        return false;
+    }
+    if (words[2] == "value") {
+        if (words.size() != 4 || !validateValue(words[3])) {
+            return false;
+        }
+        scheduler->setNodeValue(id->second, strToInt(words[3]));
+        return true;
+    }
+    Expression expression;
+    vector<string> symbols(words.begin() + 3, words.end());
+    if (!symbols.empty() && !compileExpr(symbols, id->second, words[1], expression)) {
+        return false;
+    }
+    scheduler->setNodeExpression(id->second, expression.code);
+    return true;
+}
+
+// reload the config whenever it is saved. editors often save by renaming a
+// new file over the old one, so the directory is watched for its name.
+Scheduler* runWatch(Scheduler* scheduler, Options options) {
+    size_t slash = options.fileName.rfind('/');
+    string directory = slash == string::npos ? "." : options.fileName.substr(0, slash + 1);
+    string name = options.fileName.substr(slash == string::npos ? 0 : slash + 1);
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd == -1 || inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+        cerr << "Could not watch the configuration file: " << options.fileName << "\n";
+        if (fd != -1) {
+            close(fd);
+        }
+        return scheduler;
+    }
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+        bool saved = false;
+        const struct inotify_event* event;
+        for (char* next = buffer; next < buffer + length; next += sizeof(*event) + event->len) {
+            event = (const struct inotify_event*) next;
+            saved |= event->len > 0 && name == event->name;
+        }
+        if (saved) {
+            scheduler = reloadConfig(scheduler, options);
+            cout.flush();
+        }
+    }
+    close(fd);
+    return scheduler;
+}
+
+// when the nodes and edges are the same only the changed values and
+// expressions are applied and recomputed, otherwise the new graph is run
+Scheduler* reloadConfig(Scheduler* scheduler, Options options) {
+    NodeStore* nodes = new NodeStore();
+    ConfigParser parser(options.fileName);
+    if (!parser.parse(*nodes)) {
+        cout << "The configuration file could not be parsed.\n";
+        delete nodes;
+        return scheduler;
+    }
+    bool same = scheduler->isAcyclic() && sameStructure(scheduler, *nodes);
+    if (options.optimize) {
+        // sharing into the loaded graph's shared expressions, unchanged
+        // expressions compare equal
+        optimizeExpressions(*nodes, same ? scheduler->getNodes().getSharedExprs()
+                                         : nodes->getSharedExprs());
+    }
+    if (same) {
+        const NodeStore &loaded = scheduler->getNodes();
+        for (int i = 0, max = nodes->size(); i < max; i++) {
+            if (nodes->getConfiguredValue(i) != loaded.getConfiguredValue(i)) {
+                scheduler->setNodeValue(i, nodes->getConfiguredValue(i));
+            }
+            if (!sameExpression(nodes->getExpression(i), loaded.getExpression(i))) {
+                scheduler->setNodeExpression(i, nodes->getExpression(i));
+            }
+        }
+        delete nodes;
+        scheduler->printResult(scheduler->recompute());
+        return scheduler;
+    }
+    delete scheduler;
+    scheduler = new Scheduler(nodes, options.threads, options.backend);
+    if (!scheduler->isAcyclic()) {
+        cerr << "The dependencies of the configuration file form a cycle.\n";
+        return scheduler;
+    }
+    configureScheduler(scheduler, options);
+    scheduler->printResult(options.simulate ? scheduler->simulate() : scheduler->run());
+    return scheduler;
+}
+
+// how a run is scheduled and printed, the same for the first run and for
+// every graph reloaded after it
+void configureScheduler(Scheduler* scheduler, Options options) {
+    scheduler->setPolicy(options.policy);
+    scheduler->setFusion(options.fuse);
+    scheduler->setOutputFormat(options.output);
+}
+
+bool sameStructure(Scheduler* scheduler, const NodeStore &nodes) {
+    const NodeStore &loaded = scheduler->getNodes();
+    if (loaded.size() != nodes.size()) {
+        return false;
+    }
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        Span<NodeId> deps = nodes.getDependencies(i);
+        Span<NodeId> loadedDeps = loaded.getDependencies(i);
+        if (loaded.getName(i) != nodes.getName(i)
+                || loaded.getDuration(i) != nodes.getDuration(i)
+                || !equal(deps.begin(), deps.end(), loadedDeps.begin(), loadedDeps.end())) {
+            return false;
+        }
+    }
+    return true;
+}
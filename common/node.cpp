@@ -0,0 +1,724 @@
+// Dylan Richardson
+#include "node.hpp"
+#include <iostream>
+#include <algorithm>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+
+using namespace std;
+
+const char SYMBOL_ID = 'I';
+const char SYMBOL_TOTAL = 'V';
+const string_view SYMBOL_OPERATORS = "+-*/%";
+const OpCode OPERATOR_CODES[] = { OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD };
+
+const char* compileSymbol(string_view symbol, NodeId id, Instruction &instruction) {
+    instruction.arg = 0;
+    if (symbol.length() == 1 && symbol[0] == SYMBOL_ID) {
+        instruction.op = OP_ID;
+        instruction.arg = id;
+    } else if (symbol.length() == 1 && symbol[0] == SYMBOL_TOTAL) {
+        instruction.op = OP_TOTAL;
+    } else if (parseInteger(symbol, instruction.arg)) {
+        instruction.op = OP_PUSH;
+    } else if (symbol.length() == 1
+            && SYMBOL_OPERATORS.find(symbol[0]) != string_view::npos) {
+        instruction.op = OPERATOR_CODES[SYMBOL_OPERATORS.find(symbol[0])];
+    } else {
+        return "must be an integer, I, V or one of +-*/%";
+    }
+    return NULL;
+}
+
+// compile the next RPN symbol to bytecode, tracking the stack depth so that
+// a malformed expression is rejected here instead of when it is evaluated.
+// returns why the symbol is invalid or NULL when it compiled.
+const char* appendSymbol(string_view symbol, NodeId id, Expression &expression, int &depth) {
+    Instruction instruction;
+    const char* error = compileSymbol(symbol, id, instruction);
+    if (error) {
+        return error;
+    }
+    if (isOperand(instruction.op)) {
+        depth++;
+    } else if (depth < 2) {
+        return "is missing an operand";
+    } else {
+        depth--;
+    }
+    if (depth > MAX_STACK_DEPTH) {
+        return "nests the expression too deeply";
+    }
+    expression.code.push_back(instruction);
+    return NULL;
+}
+
+// returns why the compiled expression is incomplete or NULL when it is not
+const char* finishExpr(const Expression &expression, int depth) {
+    if (!expression.code.empty() && depth != 1) {
+        return "leaves more than one value";
+    }
+    return NULL;
+}
+
+bool compileExpr(const vector<string> &symbols, NodeId id, const string &name,
+                 Expression &expression) {
+    int depth = 0;
+    expression.code.clear();
+    for (size_t i = 0, max = symbols.size(); i < max; i++) {
+        const char* error = appendSymbol(symbols[i], id, expression, depth);
+        if (error) {
+            cerr << "Symbol '" << symbols[i] << "' of node " << name << " " << error << ".\n";
+            return false;
+        }
+    }
+    const char* error = finishExpr(expression, depth);
+    if (error) {
+        cerr << "Expression of node " << name << " " << error << ".\n";
+        return false;
+    }
+    return true;
+}
+
+NodeStore::NodeStore()
+    : nodeCount(0), edgeCount(0), codeCount(0), codeCapacity(0), namesSize(0), arena(NULL),
+      arenaSize(0), mapping(NULL), mappingSize(0), addedCodeOffsets(1, 0),
+      addedNameOffsets(1, 0) {}
+
+NodeStore::~NodeStore() {
+    releaseArena();
+}
+
+void NodeStore::releaseArena() {
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    } else {
+        free(arena);
+    }
+    arena = NULL;
+    arenaSize = 0;
+    mapping = NULL;
+    mappingSize = 0;
+}
+
+// empty the store for another graph, keeping the arena to lay it out in
+// if it fits
+void NodeStore::reset() {
+    nodeCount = 0;
+    codeCount = 0;
+    sharedExprs.exprs.clear();
+    sharedExprs.ids.clear();
+    addedDurations.clear();
+    addedValues.clear();
+    addedCode.clear();
+    addedCodeOffsets.assign(1, 0);
+    addedNames.clear();
+    addedNameOffsets.assign(1, 0);
+}
+
+NodeId NodeStore::addNode(string_view name, int duration, int value, const Expression &expression) {
+    addedDurations.push_back(duration);
+    addedValues.push_back(value);
+    addedCode.insert(addedCode.end(), expression.code.begin(), expression.code.end());
+    addedCodeOffsets.push_back(addedCode.size());
+    addedNames.append(name);
+    addedNameOffsets.push_back(addedNames.size());
+    return nodeCount++;
+}
+
+void NodeStore::build(const Csr &dependencies) {
+    build(dependencies, dependencies.transpose());
+}
+
+// lay the added nodes and the edges out in the arena
+void NodeStore::build(const Csr &dependencies, const Csr &nextNodes) {
+    allocate(dependencies.indices.size(), addedCode.size(), addedNames.size());
+    copy(addedDurations.begin(), addedDurations.end(), durations);
+    copy(addedValues.begin(), addedValues.end(), values);
+    fill(totalDurations, totalDurations + nodeCount, -1);
+    for (int i = 0; i < nodeCount; i++) {
+        depCounts[i] = dependencies.rowSize(i);
+        codeOffsets[i] = addedCodeOffsets[i];
+        codeLengths[i] = addedCodeOffsets[i + 1] - addedCodeOffsets[i];
+    }
+    copy(dependencies.offsets.begin(), dependencies.offsets.end(), depOffsets);
+    copy(dependencies.indices.begin(), dependencies.indices.end(), deps);
+    copy(nextNodes.offsets.begin(), nextNodes.offsets.end(), nextOffsets);
+    copy(nextNodes.indices.begin(), nextNodes.indices.end(), next);
+    copy(addedNameOffsets.begin(), addedNameOffsets.end(), nameOffsets);
+    copy(addedNames.begin(), addedNames.end(), names);
+    copy(addedCode.begin(), addedCode.end(), code);
+    codeCount = addedCode.size();
+    vector<int>().swap(addedDurations);
+    vector<int>().swap(addedValues);
+    vector<Instruction>().swap(addedCode);
+    vector<int>().swap(addedCodeOffsets);
+    string().swap(addedNames);
+    vector<int>().swap(addedNameOffsets);
+}
+
+static size_t section(size_t &offset, size_t bytes) {
+    size_t start = offset;
+    offset += (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    return start;
+}
+
+// point every array into the arena at base, the code pool last so that it
+// can grow without moving the rest. returns the size of the arena, base
+// may be NULL to only measure it.
+size_t NodeStore::layout(char* base) {
+    uintptr_t start = (uintptr_t) base;
+    size_t offset = 0;
+    size_t ints = nodeCount * sizeof(int);
+    size_t rows = (nodeCount + 1) * sizeof(int);
+    durations = (int*) (start + section(offset, ints));
+    values = (int*) (start + section(offset, ints));
+    totalDurations = (int*) (start + section(offset, ints));
+    depCounts = (int*) (start + section(offset, ints));
+    depOffsets = (int*) (start + section(offset, rows));
+    deps = (NodeId*) (start + section(offset, edgeCount * sizeof(NodeId)));
+    nextOffsets = (int*) (start + section(offset, rows));
+    next = (NodeId*) (start + section(offset, edgeCount * sizeof(NodeId)));
+    codeOffsets = (int*) (start + section(offset, ints));
+    codeLengths = (int*) (start + section(offset, ints));
+    nameOffsets = (int*) (start + section(offset, rows));
+    names = (char*) (start + section(offset, namesSize));
+    code = (Instruction*) (start + section(offset, codeCapacity * sizeof(Instruction)));
+    return offset;
+}
+
+void NodeStore::allocate(int edgeCount, int codeCapacity, int namesSize) {
+    this->edgeCount = edgeCount;
+    this->codeCapacity = codeCapacity;
+    this->namesSize = namesSize;
+    size_t size = layout(NULL);
+    if (size > arenaSize || mapping) {
+        releaseArena();
+        arena = (char*) aligned_alloc(CACHE_LINE, size);
+        arenaSize = size;
+    }
+    layout(arena);
+}
+
+// move the arena to a larger one with room for extra more instructions
+void NodeStore::growCode(int extra) {
+    size_t used = (char*) (code + codeCount) - arena;
+    codeCapacity = std::max(codeCapacity * 2, codeCount + extra);
+    size_t size = layout(NULL);
+    char* grown = (char*) aligned_alloc(CACHE_LINE, size);
+    memcpy(grown, arena, used);
+    releaseArena();
+    arena = grown;
+    arenaSize = size;
+    layout(arena);
+}
+
+StoreSizes NodeStore::getSizes() const {
+    StoreSizes sizes = { nodeCount, edgeCount, codeCount, namesSize };
+    return sizes;
+}
+
+// the arena up to the end of the code in use. laid out again with a code
+// pool of just that code, it takes the same size rounded up to a cache line,
+// so it can be saved and run again without building
+Span<char> NodeStore::getImage() const {
+    return Span<char>(arena, (char*) (code + codeCount) - arena);
+}
+
+// take the sizes of a saved image, false if they do not lay out to the size
+// it has
+bool NodeStore::fitsImage(size_t size, const StoreSizes &sizes) {
+    nodeCount = sizes.nodeCount;
+    edgeCount = sizes.edgeCount;
+    codeCount = sizes.codeCount;
+    codeCapacity = sizes.codeCount;
+    namesSize = sizes.namesSize;
+    if (nodeCount < 0 || edgeCount < 0 || codeCount < 0 || namesSize < 0
+            || layout(NULL) != size) {
+        this->nodeCount = 0;
+        this->codeCount = 0;
+        layout(arena);
+        return false;
+    }
+    return true;
+}
+
+void NodeStore::finishImage() {
+    vector<int>().swap(addedDurations);
+    vector<int>().swap(addedValues);
+    vector<Instruction>().swap(addedCode);
+    vector<int>().swap(addedCodeOffsets);
+    string().swap(addedNames);
+    vector<int>().swap(addedNameOffsets);
+}
+
+// lay the empty store out in a saved image where it lies in a private
+// mapping, which the store unmaps once it is done with it. nothing is
+// copied, a page is only copied if the graph writes to it.
+bool NodeStore::mapImage(char* image, size_t size, const StoreSizes &sizes, void* mapping,
+                         size_t mappingSize) {
+    if (!fitsImage(size, sizes)) {
+        return false;
+    }
+    releaseArena();
+    arena = image;
+    arenaSize = size;
+    this->mapping = mapping;
+    this->mappingSize = mappingSize;
+    layout(arena);
+    finishImage();
+    return true;
+}
+
+// lay the empty store out in a copy of a saved image, in its own arena if
+// the image fits
+bool NodeStore::copyImage(const char* image, size_t size, const StoreSizes &sizes) {
+    if (!fitsImage(size, sizes)) {
+        return false;
+    }
+    allocate(sizes.edgeCount, sizes.codeCount, sizes.namesSize);
+    memcpy(arena, image, size);
+    finishImage();
+    return true;
+}
+
+static bool validRows(const int* offsets, int rowCount, int size) {
+    for (int i = 0; i < rowCount; i++) {
+        if (offsets[i] > offsets[i + 1]) {
+            return false;
+        }
+    }
+    return offsets[0] == 0 && offsets[rowCount] == size;
+}
+
+static bool validIds(const NodeId* ids, int count, int nodeCount) {
+    for (int i = 0; i < count; i++) {
+        if (ids[i] < 0 || ids[i] >= nodeCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// plain compiled bytecode that fits the stack, shared expressions only
+// exist in memory
+static bool validCode(Span<Instruction> expression) {
+    int depth = 0;
+    for (size_t i = 0, max = expression.size(); i < max; i++) {
+        int op = expression[i].op;
+        if (op < OP_PUSH || op > OP_MOD || op == OP_SHARED) {
+            return false;
+        }
+        depth += isOperand((OpCode) op) ? 1 : -1;
+        if (depth < 1 || depth > MAX_STACK_DEPTH) {
+            return false;
+        }
+    }
+    return expression.empty() || depth == 1;
+}
+
+// returns why a saved image does not hold a graph the store can read or
+// NULL when every offset, id and expression in it is in range. the order
+// of the graph is not checked here.
+const char* NodeStore::checkImage() const {
+    if (!validRows(depOffsets, nodeCount, edgeCount) || !validRows(nextOffsets, nodeCount, edgeCount)
+            || !validIds(deps, edgeCount, nodeCount) || !validIds(next, edgeCount, nodeCount)) {
+        return "has invalid edges";
+    }
+    if (!validRows(nameOffsets, nodeCount, namesSize)) {
+        return "has invalid names";
+    }
+    for (int i = 0; i < nodeCount; i++) {
+        // in 64 bits so that a huge offset and length can not wrap around
+        if (durations[i] < 0 || depCounts[i] != depOffsets[i + 1] - depOffsets[i]
+                || nameOffsets[i] == nameOffsets[i + 1]
+                || codeOffsets[i] < 0 || codeLengths[i] < 0
+                || (int64_t) codeOffsets[i] + codeLengths[i] > codeCount
+                || !validCode(getExpression(i))) {
+            return "has an invalid node";
+        }
+    }
+    return NULL;
+}
+
+// derive the next nodes from the dependencies again, for an image whose
+// next nodes do not agree with them
+void NodeStore::rebuildNextNodes() {
+    Csr dependencies;
+    dependencies.offsets.assign(depOffsets, depOffsets + nodeCount + 1);
+    dependencies.indices.assign(deps, deps + edgeCount);
+    Csr nextNodes = dependencies.transpose();
+    copy(nextNodes.offsets.begin(), nextNodes.offsets.end(), nextOffsets);
+    copy(nextNodes.indices.begin(), nextNodes.indices.end(), next);
+}
+
+int NodeStore::size() const {
+    return nodeCount;
+}
+
+string_view NodeStore::getName(NodeId id) const {
+    return string_view(names + nameOffsets[id], nameOffsets[id + 1] - nameOffsets[id]);
+}
+
+int NodeStore::getDuration(NodeId id) const {
+    return durations[id];
+}
+
+int NodeStore::getTotalDuration(NodeId id) const {
+    return totalDurations[id];
+}
+
+void NodeStore::setTotalDuration(NodeId id, int duration) {
+    totalDurations[id] = duration;
+}
+
+int NodeStore::getConfiguredValue(NodeId id) const {
+    return values[id];
+}
+
+void NodeStore::setValue(NodeId id, int value) {
+    values[id] = value;
+}
+
+int NodeStore::getDepCount(NodeId id) const {
+    return depCounts[id];
+}
+
+Span<NodeId> NodeStore::getDependencies(NodeId id) const {
+    return Span<NodeId>(deps + depOffsets[id], depCounts[id]);
+}
+
+Span<NodeId> NodeStore::getNextNodes(NodeId id) const {
+    return Span<NodeId>(next + nextOffsets[id], nextOffsets[id + 1] - nextOffsets[id]);
+}
+
+Span<Instruction> NodeStore::getExpression(NodeId id) const {
+    return Span<Instruction>(code + codeOffsets[id], codeLengths[id]);
+}
+
+// an expression that fits where the old one was replaces it in place, a
+// longer one is appended to the code pool
+void NodeStore::setExpression(NodeId id, Span<Instruction> expression) {
+    if ((int) expression.size() > codeLengths[id]) {
+        if (codeCount + (int) expression.size() > codeCapacity) {
+            growCode(expression.size());
+        }
+        codeOffsets[id] = codeCount;
+        codeCount += expression.size();
+    }
+    copy(expression.begin(), expression.end(), code + codeOffsets[id]);
+    codeLengths[id] = expression.size();
+}
+
+// the value is known without evaluating, either the configured value or
+// an expression folded to a literal
+bool NodeStore::isConstant(NodeId id) const {
+    Span<Instruction> expression = getExpression(id);
+    return expression.empty() || (expression.size() == 1 && expression[0].op == OP_PUSH);
+}
+
+// total is the sum of the values of the dependencies, which have all
+// completed before the node runs, so V is the same in every run
+int NodeStore::getValue(NodeId id, int total) const {
+    Span<Instruction> expression = getExpression(id);
+    if (expression.empty()) {
+        return values[id];
+    } else if (expression.size() == 1 && expression[0].op == OP_PUSH) {
+        return expression[0].arg;
+    } else {
+        return evalExpr(expression, total, sharedExprs);
+    }
+}
+
+// value of the node in every scenario or element of a vector, column holds
+// the values of a node without an expression or NULL to use its own value
+// in all of them
+void NodeStore::getValues(NodeId id, const int* column, const int* totals, int* values,
+                          int count) const {
+    Span<Instruction> expression = getExpression(id);
+    if (!expression.empty()) {
+        evalExprBatch(expression, sharedExprs, totals, values, count);
+    } else if (column) {
+        copy(column, column + count, values);
+    } else {
+        fill(values, values + count, this->values[id]);
+    }
+}
+
+SharedExprs &NodeStore::getSharedExprs() {
+    return sharedExprs;
+}
+
+int evalExpr(Span<Instruction> code, int total, const SharedExprs &shared) {
+    // the expression was compiled to fit this stack
+    int stack[MAX_STACK_DEPTH];
+    int top = 0;
+    for (size_t i = 0, max = code.size(); i < max; i++) {
+        switch (code[i].op) {
+            case OP_PUSH:
+            case OP_ID:
+                stack[top++] = code[i].arg;
+                break;
+            case OP_TOTAL:
+                stack[top++] = total;
+                break;
+            case OP_SHARED:
+                stack[top++] = evalShared(shared, code[i].arg, total);
+                break;
+            default:
+                top--;
+                stack[top - 1] = calculate(code[i].op, stack[top - 1], stack[top]);
+                break;
+        }
+    }
+    return stack[0];
+}
+
+// every slot starts out holding the value for a V of zero so that it is
+// always valid
+SharedExpr::SharedExpr(Expression expression, const SharedExprs &shared)
+        : expression(expression) {
+    uint64_t zero = (uint32_t) evalExpr(expression.code, 0, shared);
+    for (int i = 0; i < MEMO_SLOTS; i++) {
+        memo[i].store(zero, std::memory_order_relaxed);
+    }
+}
+
+// fibonacci hashing, nearby V such as the totals of sibling nodes land in
+// different slots
+static inline int memoSlot(int total) {
+    return ((uint32_t) total * 2654435761u) >> (32 - MEMO_SLOT_BITS);
+}
+
+// workers may race to fill a slot, but each store is a whole V and value
+// pair and any of them is correct for its V
+int evalShared(const SharedExprs &shared, int id, int total) {
+    const SharedExpr &expr = shared.exprs[id];
+    std::atomic<uint64_t> &slot = expr.memo[memoSlot(total)];
+    uint64_t memo = slot.load(std::memory_order_relaxed);
+    if ((int) (memo >> 32) == total) {
+        return (int) (uint32_t) memo;
+    }
+    int value = evalExpr(expr.expression.code, total, shared);
+    slot.store((uint64_t) (uint32_t) total << 32 | (uint32_t) value, std::memory_order_relaxed);
+    return value;
+}
+
+// one vector register of values, AVX2 holds all eight lanes at once
+const int LANES = 8;
+typedef int Lanes __attribute__((vector_size(LANES * sizeof(int))));
+
+// values evaluated together. every op of an expression runs over the whole
+// block, so its opcode is dispatched once for BLOCK values
+const int BLOCK_LANES = 8;
+const int BLOCK = BLOCK_LANES * LANES;
+struct LaneBlock {
+    Lanes lanes[BLOCK_LANES];
+};
+
+// the result replaces the first argument
+static inline __attribute__((always_inline))
+void calculateBlock(OpCode op, LaneBlock &arg1, const LaneBlock &arg2) {
+    switch (op) {
+        case OP_ADD:
+            for (int i = 0; i < BLOCK_LANES; i++) {
+                arg1.lanes[i] += arg2.lanes[i];
+            }
+            break;
+        case OP_SUB:
+            for (int i = 0; i < BLOCK_LANES; i++) {
+                arg1.lanes[i] -= arg2.lanes[i];
+            }
+            break;
+        case OP_MUL:
+            for (int i = 0; i < BLOCK_LANES; i++) {
+                arg1.lanes[i] *= arg2.lanes[i];
+            }
+            break;
+        default:
+            // there is no vector integer division, fall back to each lane
+            for (int i = 0; i < BLOCK_LANES; i++) {
+                for (int j = 0; j < LANES; j++) {
+                    arg1.lanes[i][j] = calculate(op, arg1.lanes[i][j], arg2.lanes[i][j]);
+                }
+            }
+            break;
+    }
+}
+
+// evaluate a block of values, compiled once for AVX2 and once for the
+// baseline SSE2 with the best one picked when the program loads
+__attribute__((target_clones("avx2", "default")))
+void evalExprBlock(Span<Instruction> code, const SharedExprs &shared, const LaneBlock &totals,
+                   LaneBlock &result) {
+    LaneBlock stack[MAX_STACK_DEPTH];
+    int top = 0;
+    for (size_t i = 0, max = code.size(); i < max; i++) {
+        switch (code[i].op) {
+            case OP_PUSH:
+            case OP_ID:
+                for (int j = 0; j < BLOCK_LANES; j++) {
+                    stack[top].lanes[j] = (Lanes) {} + code[i].arg;
+                }
+                top++;
+                break;
+            case OP_TOTAL:
+                stack[top++] = totals;
+                break;
+            case OP_SHARED:
+                evalExprBlock(shared.exprs[code[i].arg].expression.code, shared, totals,
+                              stack[top++]);
+                break;
+            default:
+                top--;
+                calculateBlock(code[i].op, stack[top - 1], stack[top]);
+                break;
+        }
+    }
+    result = stack[0];
+}
+
+// totals and values may be the same array, each block of totals is read
+// before its values are written
+void evalExprBatch(Span<Instruction> code, const SharedExprs &shared, const int* totals,
+                   int* values, int count) {
+    for (int start = 0; start < count; start += BLOCK) {
+        int size = min(BLOCK, count - start);
+        LaneBlock group = {};
+        LaneBlock result;
+        copy(totals + start, totals + start + size, (int*) &group);
+        evalExprBlock(code, shared, group, result);
+        copy((int*) &result, (int*) &result + size, values + start);
+    }
+}
+
+// add values into totals element by element
+__attribute__((target_clones("avx2", "default")))
+void addValues(int* totals, const int* values, int count) {
+    int i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        Lanes total;
+        Lanes value;
+        memcpy(&total, totals + i, sizeof(Lanes));
+        memcpy(&value, values + i, sizeof(Lanes));
+        total += value;
+        memcpy(totals + i, &total, sizeof(Lanes));
+    }
+    for (; i < count; i++) {
+        totals[i] += values[i];
+    }
+}
+
+// the sum of count values, added up one register at a time
+__attribute__((target_clones("avx2", "default")))
+int sumValues(const int* values, int count) {
+    Lanes sums = {};
+    int i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        Lanes value;
+        memcpy(&value, values + i, sizeof(Lanes));
+        sums += value;
+    }
+    int sum = 0;
+    for (int j = 0; j < LANES; j++) {
+        sum += sums[j];
+    }
+    for (; i < count; i++) {
+        sum += values[i];
+    }
+    return sum;
+}
+
+// operands push a value, every other op combines the top two
+bool isOperand(OpCode op) {
+    return op < OP_ADD;
+}
+
+int calculate(OpCode op, int arg1, int arg2) {
+    switch (op) {
+        case OP_ADD:
+            return arg1 + arg2;
+        case OP_SUB:
+            return arg1 - arg2;
+        case OP_MUL:
+            return arg1 * arg2;
+        // dividing by zero gives zero, and INT_MIN / -1 wraps like the
+        // other operators instead of trapping
+        case OP_DIV:
+            return arg2 == 0 ? 0 : arg2 == -1 ? (int) (0u - (unsigned) arg1) : arg1 / arg2;
+        case OP_MOD:
+            return arg2 == 0 || arg2 == -1 ? 0 : arg1 % arg2;
+        default:
+            return 0;
+    }
+}
+
+bool sameExpression(Span<Instruction> a, Span<Instruction> b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0, max = a.size(); i < max; i++) {
+        if (a[i].op != b[i].op || a[i].arg != b[i].arg) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the same edges pointing the other way, built with a counting sort so it
+// is linear in the number of rows and edges
+Csr Csr::transpose() const {
+    Csr result;
+    int rows = rowCount();
+    result.offsets.assign(rows + 1, 0);
+    result.indices.resize(indices.size());
+    for (size_t i = 0, max = indices.size(); i < max; i++) {
+        result.offsets[indices[i] + 1]++;
+    }
+    for (int row = 0; row < rows; row++) {
+        result.offsets[row + 1] += result.offsets[row];
+    }
+    vector<int> next(result.offsets.begin(), result.offsets.end() - 1);
+    for (int row = 0; row < rows; row++) {
+        for (const NodeId* it = rowBegin(row); it != rowEnd(row); it++) {
+            result.indices[next[*it]++] = row;
+        }
+    }
+    return result;
+}
+
+int strToInt(string str) {
+    return atoi(str.c_str());
+}
+
+bool isInteger(const string &str) {
+    int value;
+    return parseInteger(str, value);
+}
+
+// parse an optionally signed decimal integer that fits in an int
+bool parseInteger(string_view str, int &value) {
+    size_t i = 0;
+    bool negative = false;
+    if (!str.empty() && (str[0] == '-' || str[0] == '+')) {
+        negative = str[0] == '-';
+        i++;
+    }
+    if (i == str.length()) {
+        return false;
+    }
+    long result = 0;
+    for (; i < str.length(); i++) {
+        if (str[i] < '0' || str[i] > '9') {
+            return false;
+        }
+        result = result * 10 + (str[i] - '0');
+        if (result > (long) INT_MAX + negative) {
+            return false;
+        }
+    }
+    value = negative ? -result : result;
+    return true;
+}
@@ -0,0 +1,205 @@
+#ifndef NODE_H
+#define NODE_H
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+const int MAX_STACK_DEPTH = 64;
+
+// every array of the arena starts a cache line
+const size_t CACHE_LINE = 64;
+
+// node names are interned to dense ids in the order they are defined
+typedef int NodeId;
+
+// compressed sparse rows, row i holds the ids from
+// indices[offsets[i]] up to indices[offsets[i + 1]]
+struct Csr {
+    std::vector<int> offsets;
+    std::vector<NodeId> indices;
+    Csr() : offsets(1, 0) {}
+    int rowCount() const { return offsets.size() - 1; }
+    int rowSize(int row) const { return offsets[row + 1] - offsets[row]; }
+    const NodeId* rowBegin(int row) const { return indices.data() + offsets[row]; }
+    const NodeId* rowEnd(int row) const { return indices.data() + offsets[row + 1]; }
+    void endRow() { offsets.push_back(indices.size()); }
+    Csr transpose() const;
+};
+
+// a read-only view of count elements laid out one after another
+template <typename T>
+class Span {
+    public:
+        Span() : first(NULL), count(0) {}
+        Span(const T* first, size_t count) : first(first), count(count) {}
+        Span(const std::vector<T> &elements) : first(elements.data()), count(elements.size()) {}
+        const T* begin() const { return first; }
+        const T* end() const { return first + count; }
+        const T* data() const { return first; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const T &operator[](size_t i) const { return first[i]; }
+    private:
+        const T* first;
+        size_t count;
+};
+
+enum OpCode {
+    OP_PUSH,   // push the immediate
+    OP_ID,     // push the immediate, which is the id of the node
+    OP_TOTAL,  // push the total of the values of the dependencies
+    OP_SHARED, // push the value of the shared expression the immediate names
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD
+};
+
+struct Instruction {
+    OpCode op;
+    int arg;
+};
+
+// an RPN expression compiled at load time, the node id is already resolved
+// to an immediate and the stack depth is known to fit MAX_STACK_DEPTH
+struct Expression {
+    std::vector<Instruction> code;
+};
+
+struct SharedExprs;
+
+// the V a shared expression remembers values for. nodes that run at the
+// same time rarely depend on the same nodes, so one entry would be
+// overwritten by every worker in turn
+const int MEMO_SLOT_BITS = 5;
+const int MEMO_SLOTS = 1 << MEMO_SLOT_BITS;
+
+// an expression that several nodes have in common and that does not
+// depend on I, so it only has to be evaluated once for each V. the memo is
+// indexed by a hash of V, each slot packs its V in the high half and the
+// value in the low half, and a hit only reads its slot.
+struct SharedExpr {
+    Expression expression;
+    mutable std::atomic<uint64_t> memo[MEMO_SLOTS];
+    SharedExpr(Expression, const SharedExprs &shared);
+};
+
+// the code of an expression as comparable pairs of op and argument
+typedef std::vector<std::pair<int, int> > CodeKey;
+
+// the shared expressions of a graph by id, and the id of each by its code
+// so that the same subtree is interned to the same expression every time
+struct SharedExprs {
+    std::deque<SharedExpr> exprs;
+    std::map<CodeKey, int> ids;
+};
+
+// the counts a store is laid out from, which lay a saved arena out again
+struct StoreSizes {
+    int nodeCount;
+    int edgeCount;
+    int codeCount;
+    int namesSize;
+};
+
+// the nodes of a graph as parallel arrays in one arena, so that the
+// scheduler reads the few fields it needs from contiguous memory and the
+// graph is freed at once. nodes are added while the graph is parsed and
+// laid out by build once every edge is known, after which only values,
+// total durations and expressions change.
+class NodeStore {
+    public:
+        NodeStore();
+        ~NodeStore();
+        NodeId addNode(std::string_view name, int duration, int value, const Expression &expression);
+        void build(const Csr &dependencies);
+        void build(const Csr &dependencies, const Csr &nextNodes);
+        void reset();
+        StoreSizes getSizes() const;
+        Span<char> getImage() const;
+        bool mapImage(char* image, size_t size, const StoreSizes &sizes, void* mapping,
+                      size_t mappingSize);
+        bool copyImage(const char* image, size_t size, const StoreSizes &sizes);
+        const char* checkImage() const;
+        void rebuildNextNodes();
+        int size() const;
+        std::string_view getName(NodeId) const;
+        int getDuration(NodeId) const;
+        int getTotalDuration(NodeId) const;
+        void setTotalDuration(NodeId, int);
+        int getConfiguredValue(NodeId) const;
+        void setValue(NodeId, int);
+        int getDepCount(NodeId) const;
+        Span<NodeId> getDependencies(NodeId) const;
+        Span<NodeId> getNextNodes(NodeId) const;
+        Span<Instruction> getExpression(NodeId) const;
+        void setExpression(NodeId, Span<Instruction>);
+        bool isConstant(NodeId) const;
+        int getValue(NodeId, int total) const;
+        void getValues(NodeId, const int* column, const int* totals, int* values, int count) const;
+        SharedExprs &getSharedExprs();
+    private:
+        int nodeCount;
+        int edgeCount;
+        int codeCount; // instructions in use, at the end of the code pool
+        int codeCapacity;
+        int namesSize;
+        char* arena;
+        size_t arenaSize;
+        void* mapping; // the mapped file the arena lies in, or NULL if it was allocated
+        size_t mappingSize;
+        int* durations;
+        int* values;
+        int* totalDurations;
+        int* depCounts;
+        int* depOffsets;
+        NodeId* deps;
+        int* nextOffsets;
+        NodeId* next;
+        int* codeOffsets;
+        int* codeLengths;
+        Instruction* code;
+        int* nameOffsets;
+        char* names;
+        SharedExprs sharedExprs;
+        // nodes added before build
+        std::vector<int> addedDurations;
+        std::vector<int> addedValues;
+        std::vector<Instruction> addedCode;
+        std::vector<int> addedCodeOffsets;
+        std::string addedNames;
+        std::vector<int> addedNameOffsets;
+
+        size_t layout(char*);
+        void allocate(int, int, int);
+        void growCode(int);
+        void releaseArena();
+        bool fitsImage(size_t, const StoreSizes &sizes);
+        void finishImage();
+};
+
+int evalExpr(Span<Instruction> code, int total, const SharedExprs &shared);
+bool isOperand(OpCode);
+int calculate(OpCode, int, int);
+int evalShared(const SharedExprs &shared, int, int total);
+void evalExprBatch(Span<Instruction> code, const SharedExprs &shared, const int* totals,
+                   int* values, int count);
+void addValues(int* totals, const int* values, int count);
+int sumValues(const int* values, int count);
+bool sameExpression(Span<Instruction> a, Span<Instruction> b);
+const char* appendSymbol(std::string_view symbol, NodeId, Expression &expression, int &depth);
+const char* finishExpr(const Expression &expression, int depth);
+bool compileExpr(const std::vector<std::string> &symbols, NodeId, const std::string &name,
+                 Expression &expression);
+int strToInt(std::string);
+bool isInteger(const std::string &str);
+bool parseInteger(std::string_view str, int &value);
+
+#endif
@@ -0,0 +1,168 @@
+// Dylan Richardson
+#include "optimize.hpp"
+#include "node.hpp"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+// the subtree of an expression ending at each instruction. in RPN the code
+// of a subtree is the span from its first instruction to its root.
+struct ExprTree {
+    int start;
+    int parent; // the operator taking the subtree as an operand or -1
+    bool usesId; // I appears in the subtree
+};
+
+void buildTrees(Span<Instruction> code, vector<ExprTree> &trees) {
+    vector<int> stack;
+    trees.resize(code.size());
+    for (size_t i = 0, max = code.size(); i < max; i++) {
+        ExprTree &tree = trees[i];
+        tree.start = i;
+        tree.parent = -1;
+        tree.usesId = code[i].op == OP_ID;
+        if (!isOperand(code[i].op)) {
+            int right = stack.back();
+            stack.pop_back();
+            int left = stack.back();
+            stack.pop_back();
+            trees[left].parent = trees[right].parent = i;
+            tree.start = trees[left].start;
+            tree.usesId = trees[left].usesId || trees[right].usesId;
+        }
+        stack.push_back(i);
+    }
+}
+
+// the largest subtrees with an operator and without I, which are the same
+// in every node that has them
+bool isShareable(Span<Instruction> code, const vector<ExprTree> &trees, int root) {
+    return !isOperand(code[root].op) && !trees[root].usesId
+        && (trees[root].parent < 0 || trees[trees[root].parent].usesId);
+}
+
+CodeKey codeKey(Span<Instruction> code, int start, int end) {
+    CodeKey key;
+    for (int i = start; i < end; i++) {
+        key.push_back(make_pair(code[i].op, code[i].arg));
+    }
+    return key;
+}
+
+int internShared(Span<Instruction> code, int start, int end, SharedExprs &shared) {
+    CodeKey key = codeKey(code, start, end);
+    map<CodeKey, int>::iterator id = shared.ids.find(key);
+    if (id == shared.ids.end()) {
+        Expression expression;
+        expression.code.assign(code.begin() + start, code.begin() + end);
+        id = shared.ids.insert(make_pair(key, (int) shared.exprs.size())).first;
+        shared.exprs.emplace_back(expression, shared);
+    }
+    return id->second;
+}
+
+void optimizeExpressions(NodeStore &nodes) {
+    optimizeExpressions(nodes, nodes.getSharedExprs());
+}
+
+// fold first so that constant subtrees are not shared. the shared
+// expressions may belong to another store holding the same graph, so that
+// expressions of the two compare equal
+void optimizeExpressions(NodeStore &nodes, SharedExprs &shared) {
+    foldConstants(nodes);
+    shareSubexpressions(nodes, shared);
+}
+
+// a value on the stack while folding, the code pushing it starts at start
+struct FoldedValue {
+    int start;
+    bool constant;
+    int value;
+};
+
+// evaluate every subtree made only of literals and I when the graph is
+// loaded. an expression that folds completely becomes a single literal,
+// which the node returns without evaluating.
+void foldConstants(NodeStore &nodes) {
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        Span<Instruction> code = nodes.getExpression(i);
+        Expression folded;
+        vector<FoldedValue> stack;
+        for (size_t j = 0, maxj = code.size(); j < maxj; j++) {
+            Instruction instruction = code[j];
+            if (isOperand(instruction.op)) {
+                bool constant = instruction.op == OP_PUSH || instruction.op == OP_ID;
+                FoldedValue operand = { (int) folded.code.size(), constant, instruction.arg };
+                folded.code.push_back(instruction);
+                stack.push_back(operand);
+                continue;
+            }
+            FoldedValue right = stack.back();
+            stack.pop_back();
+            FoldedValue &left = stack.back();
+            if (left.constant && right.constant) {
+                Instruction literal = { OP_PUSH, calculate(instruction.op, left.value, right.value) };
+                folded.code.resize(left.start);
+                folded.code.push_back(literal);
+                left.value = literal.arg;
+            } else {
+                folded.code.push_back(instruction);
+                left.constant = false;
+            }
+        }
+        bool onlyId = folded.code.size() == 1 && folded.code[0].op == OP_ID;
+        if (onlyId) {
+            folded.code[0].op = OP_PUSH;
+        }
+        if (onlyId || folded.code.size() < code.size()) {
+            nodes.setExpression(i, folded.code);
+        }
+    }
+}
+
+// hash-cons the expressions of the graph. a subtree without I that appears
+// in more than one place is evaluated once per V through a shared expression
+// instead of in every node, since nodes depending on the same nodes see the
+// same V. subtrees that appear only once are left inline.
+void shareSubexpressions(NodeStore &nodes, SharedExprs &shared) {
+    vector<vector<ExprTree> > trees(nodes.size());
+    map<CodeKey, int> counts;
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        Span<Instruction> code = nodes.getExpression(i);
+        buildTrees(code, trees[i]);
+        for (size_t j = 0, maxj = code.size(); j < maxj; j++) {
+            if (isShareable(code, trees[i], j)) {
+                counts[codeKey(code, trees[i][j].start, j + 1)]++;
+            }
+        }
+    }
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        Span<Instruction> code = nodes.getExpression(i);
+        // the root of the shared subtree starting at each instruction
+        vector<int> sharedRoots(code.size(), -1);
+        bool sharing = false;
+        for (size_t j = 0, maxj = code.size(); j < maxj; j++) {
+            if (isShareable(code, trees[i], j)
+                    && counts[codeKey(code, trees[i][j].start, j + 1)] > 1) {
+                sharedRoots[trees[i][j].start] = j;
+                sharing = true;
+            }
+        }
+        if (!sharing) {
+            continue;
+        }
+        Expression rewritten;
+        for (size_t j = 0, maxj = code.size(); j < maxj; j++) {
+            if (sharedRoots[j] < 0) {
+                rewritten.code.push_back(code[j]);
+                continue;
+            }
+            Instruction instruction = { OP_SHARED, internShared(code, j, sharedRoots[j] + 1, shared) };
+            rewritten.code.push_back(instruction);
+            j = sharedRoots[j];
+        }
+        nodes.setExpression(i, rewritten.code);
+    }
+}
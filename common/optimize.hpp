@@ -0,0 +1,12 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "node.hpp"
+#include <vector>
+
+void optimizeExpressions(NodeStore &nodes);
+void optimizeExpressions(NodeStore &nodes, SharedExprs &shared);
+void foldConstants(NodeStore &nodes);
+void shareSubexpressions(NodeStore &nodes, SharedExprs &shared);
+
+#endif
@@ -0,0 +1,295 @@
+// Dylan Richardson
+#include "output.hpp"
+#include "node.hpp"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace std;
+
+const long RING_SIZE = 1 << 16;
+// records formatted before the batch is written
+const long BATCH_SIZE = 4096;
+// the batch buffer is handed to writev in pieces of this size
+const size_t CHUNK_SIZE = 1 << 16;
+
+ResultWriter::ResultWriter(const NodeStore &nodes, OutputFormat format, int fd, bool framed)
+        : nodes(nodes), ring(RING_SIZE) {
+    this->format = format;
+    this->fd = fd;
+    this->framed = framed;
+    this->mask = RING_SIZE - 1;
+    this->tail = 0;
+    this->head = 0;
+    this->written = 0;
+    this->sleeping = false;
+    this->stopping = false;
+    this->headerWritten = false;
+    for (long i = 0; i < RING_SIZE; i++) {
+        ring[i].sequence = i;
+    }
+    sem_init(&wake, 0, 0);
+    if (pthread_create(&thread, NULL, _runWriter, (void*) this)) {
+        cerr << "Failed to create the output thread.\n";
+    }
+}
+
+ResultWriter::~ResultWriter() {
+    flush();
+    stopping = true;
+    wakeWriter();
+    if (pthread_join(thread, NULL)) {
+        cerr << "Failed to join the output thread.\n";
+    }
+    sem_destroy(&wake);
+}
+
+void ResultWriter::push(NodeId node, int value, int time) {
+    ResultRecord record = { node, value, time };
+    pushRecord(record);
+}
+
+void ResultWriter::pushTotal(int value, int time) {
+    ResultRecord record = { -1, value, time };
+    pushRecord(record);
+}
+
+void ResultWriter::pushRecord(ResultRecord record) {
+    long position = tail.fetch_add(1);
+    Slot &slot = ring[position & mask];
+    // the ring is full until the writer frees this slot
+    while (slot.sequence.load(memory_order_acquire) != position) {
+        sched_yield();
+    }
+    slot.record = record;
+    slot.sequence.store(position + 1, memory_order_release);
+    // pairs with the writer setting sleeping before it checks the ring
+    atomic_thread_fence(memory_order_seq_cst);
+    if (sleeping.load(memory_order_relaxed)) {
+        wakeWriter();
+    }
+}
+
+void ResultWriter::wakeWriter() {
+    if (sleeping.exchange(false)) {
+        sem_post(&wake);
+    }
+}
+
+// wait until every record pushed so far has been written
+void ResultWriter::flush() {
+    long target = tail.load();
+    while (written.load(memory_order_acquire) < target) {
+        sched_yield();
+    }
+}
+
+void* ResultWriter::_runWriter(void* context) {
+    ((ResultWriter*) context)->runWriter();
+    return NULL;
+}
+
+void ResultWriter::runWriter() {
+    while (waitForRecords()) {
+        long taken = 0;
+        while (taken < BATCH_SIZE) {
+            Slot &slot = ring[head & mask];
+            if (slot.sequence.load(memory_order_acquire) != head + 1) {
+                break;
+            }
+            ResultRecord record = slot.record;
+            slot.sequence.store(head + RING_SIZE, memory_order_release);
+            head++;
+            taken++;
+            formatRecord(record);
+        }
+        writeBuffer();
+        written.store(head, memory_order_release);
+    }
+}
+
+// false once the writer is stopping and the ring is empty
+bool ResultWriter::waitForRecords() {
+    while (true) {
+        if (ring[head & mask].sequence.load(memory_order_acquire) == head + 1) {
+            return true;
+        }
+        if (stopping) {
+            return false;
+        }
+        sleeping = true;
+        atomic_thread_fence(memory_order_seq_cst);
+        if (ring[head & mask].sequence.load(memory_order_acquire) == head + 1 || stopping) {
+            sleeping = false;
+            continue;
+        }
+        sem_wait(&wake);
+    }
+}
+
+// append the decimal digits of value
+void appendInt(vector<char> &buffer, int value) {
+    char digits[12];
+    unsigned magnitude = value < 0 ? 0u - (unsigned) value : value;
+    int length = 0;
+    do {
+        digits[length++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) {
+        buffer.push_back('-');
+    }
+    while (length) {
+        buffer.push_back(digits[--length]);
+    }
+}
+
+void appendString(vector<char> &buffer, const char* str, size_t length) {
+    buffer.insert(buffer.end(), str, str + length);
+}
+
+void appendString(vector<char> &buffer, const char* str) {
+    appendString(buffer, str, strlen(str));
+}
+
+void ResultWriter::formatRecord(const ResultRecord &record) {
+    if (!headerWritten) {
+        headerWritten = true;
+        if (format == OUTPUT_CSV) {
+            appendString(buffer, "node,value,time\n");
+        } else if (format == OUTPUT_BINARY) {
+            appendString(buffer, OUTPUT_MAGIC, sizeof(OUTPUT_MAGIC));
+            appendString(buffer, (const char*) &OUTPUT_VERSION, sizeof(OUTPUT_VERSION));
+        }
+    }
+    if (format == OUTPUT_BINARY) {
+        appendString(buffer, (const char*) &record, sizeof(record));
+        return;
+    }
+    string_view name = record.node < 0 ? "total" : nodes.getName(record.node);
+    if (format == OUTPUT_CSV) {
+        appendString(buffer, name.data(), name.size());
+        buffer.push_back(',');
+        appendInt(buffer, record.value);
+        buffer.push_back(',');
+        appendInt(buffer, record.time);
+        buffer.push_back('\n');
+        return;
+    }
+    if (record.node < 0) {
+        appendString(buffer, "Total computation resulted in a value of ");
+    } else {
+        appendString(buffer, "Node ");
+        appendString(buffer, name.data(), name.size());
+        appendString(buffer, " computed a value of ");
+    }
+    appendInt(buffer, record.value);
+    appendString(buffer, " after ");
+    appendInt(buffer, record.time);
+    appendString(buffer, record.time == 1 ? " second.\n" : " seconds.\n");
+}
+
+// write the batch with as few writev calls as it takes, after anything the
+// program printed to stdout through stdio before it
+void ResultWriter::writeBuffer() {
+    // an empty frame would end a reply of the server early
+    if (buffer.empty()) {
+        return;
+    }
+    if (fd == STDOUT_FILENO) {
+        fflush(stdout);
+    }
+    vector<struct iovec> pieces;
+    int32_t frameLength = buffer.size();
+    if (framed) {
+        struct iovec piece;
+        piece.iov_base = &frameLength;
+        piece.iov_len = sizeof(frameLength);
+        pieces.push_back(piece);
+    }
+    for (size_t offset = 0; offset < buffer.size(); offset += CHUNK_SIZE) {
+        struct iovec piece;
+        piece.iov_base = buffer.data() + offset;
+        piece.iov_len = min(CHUNK_SIZE, buffer.size() - offset);
+        pieces.push_back(piece);
+    }
+    size_t next = 0;
+    while (next < pieces.size()) {
+        int count = min(pieces.size() - next, (size_t) IOV_MAX);
+        ssize_t length = writev(fd, &pieces[next], count);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length < 0) {
+            break;
+        }
+        // skip what was written, a pipe may take only part of the batch
+        while (next < pieces.size() && (size_t) length >= pieces[next].iov_len) {
+            length -= pieces[next++].iov_len;
+        }
+        if (next < pieces.size()) {
+            pieces[next].iov_base = (char*) pieces[next].iov_base + length;
+            pieces[next].iov_len -= length;
+        }
+    }
+    buffer.clear();
+}
+
+// read or write all of size bytes on a socket or pipe, false if it fails
+// or the other end closes first
+bool readFully(int fd, void* data, size_t size) {
+    char* at = (char*) data;
+    while (size > 0) {
+        ssize_t length = read(fd, at, size);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length <= 0) {
+            return false;
+        }
+        at += length;
+        size -= length;
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* data, size_t size) {
+    const char* at = (const char*) data;
+    while (size > 0) {
+        ssize_t length = write(fd, at, size);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length < 0) {
+            return false;
+        }
+        at += length;
+        size -= length;
+    }
+    return true;
+}
+
+bool outputFromString(string name, OutputFormat &format) {
+    if (name == "text") {
+        format = OUTPUT_TEXT;
+    } else if (name == "csv") {
+        format = OUTPUT_CSV;
+    } else if (name == "binary") {
+        format = OUTPUT_BINARY;
+    } else if (name == "none") {
+        format = OUTPUT_NONE;
+    } else {
+        return false;
+    }
+    return true;
+}
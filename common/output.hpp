@@ -0,0 +1,77 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "node.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <unistd.h>
+
+enum OutputFormat {
+    OUTPUT_TEXT,  // the sentences printed since the first version
+    OUTPUT_CSV,   // node,value,time rows after a header
+    OUTPUT_BINARY, // GOUT, a version, then ResultRecords in native byte order
+    OUTPUT_NONE    // nothing, for callers that only want the total
+};
+
+const char OUTPUT_MAGIC[4] = { 'G', 'O', 'U', 'T' };
+const int32_t OUTPUT_VERSION = 1;
+
+// one completed node, or the total of the graph when node is -1
+struct ResultRecord {
+    int32_t node;
+    int32_t value;
+    int32_t time;
+};
+
+// workers push records into a bounded ring without locking and a writer
+// thread formats them in batches, so no worker ever waits on the console.
+// a framed writer puts the int32 length of each batch before it.
+// a slot's sequence says whose turn it is: the producer that claimed
+// position p may fill it when it equals p and the writer may take it when
+// it equals p + 1.
+class ResultWriter {
+    public:
+        ResultWriter(const NodeStore &nodes, OutputFormat, int fd = STDOUT_FILENO, bool framed = false);
+        ~ResultWriter();
+        void push(NodeId, int value, int time);
+        void pushTotal(int value, int time);
+        void flush();
+    private:
+        struct Slot {
+            std::atomic<long> sequence;
+            ResultRecord record;
+        };
+        const NodeStore &nodes;
+        OutputFormat format;
+        int fd;
+        bool framed;
+        std::vector<Slot> ring;
+        long mask;
+        std::atomic<long> tail; // next position a producer claims
+        long head; // next position the writer takes, only it touches head
+        std::atomic<long> written; // positions the writer has written out
+        std::atomic<bool> sleeping;
+        std::atomic<bool> stopping;
+        bool headerWritten;
+        sem_t wake;
+        pthread_t thread;
+        std::vector<char> buffer;
+
+        void pushRecord(ResultRecord);
+        void wakeWriter();
+        static void* _runWriter(void*);
+        void runWriter();
+        bool waitForRecords();
+        void formatRecord(const ResultRecord &record);
+        void writeBuffer();
+};
+
+bool outputFromString(std::string, OutputFormat &format);
+bool readFully(int fd, void* data, size_t size);
+bool writeFully(int fd, const void* data, size_t size);
+
+#endif
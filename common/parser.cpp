@@ -0,0 +1,259 @@
+// Dylan Richardson
+#include "parser.hpp"
+#include "node.hpp"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+const int NAME_TOKEN = 0;
+const int VALUE_TOKEN = 1;
+const int DURATION_TOKEN = 2;
+const int DEP_TOKEN = 3;
+const string_view EQUAL_SIGN = "=";
+
+ConfigParser::ConfigParser(string fileName) {
+    this->fileName = fileName;
+    this->mapped = true;
+    this->fd = -1;
+    this->data = NULL;
+    this->size = 0;
+}
+
+// parses config text already in memory, fileName only names it in errors
+ConfigParser::ConfigParser(string fileName, string_view text) {
+    this->fileName = fileName;
+    this->mapped = false;
+    this->fd = -1;
+    this->data = text.data();
+    this->size = text.size();
+}
+
+ConfigParser::~ConfigParser() {
+    if (data && mapped) {
+        munmap((void*) data, size);
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+}
+
+bool ConfigParser::mapFile() {
+    struct stat info;
+    fd = open(fileName.c_str(), O_RDONLY);
+    if (fd == -1 || fstat(fd, &info)) {
+        cerr << "Could not find the configuration file: " << fileName << "\n";
+        return false;
+    }
+    size = info.st_size;
+    if (size == 0) {
+        return true;
+    }
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        cerr << "Could not map the configuration file: " << fileName << "\n";
+        return false;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = (const char*) mapping;
+    return true;
+}
+
+// the store is built once every line parsed
+bool ConfigParser::parse(NodeStore &nodes) {
+    if (mapped && !mapFile()) {
+        return false;
+    }
+    Csr dependencies;
+    const char* end = data + size;
+    lineNumber = 0;
+    bool parsed = true;
+    // memchr finds each line end with vector instructions
+    for (lineStart = data; parsed && lineStart < end; ) {
+        const char* lineEnd = (const char*) memchr(lineStart, '\n', end - lineStart);
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        lineNumber++;
+        tokenize(lineStart, lineEnd);
+        parsed = tokens.empty() || parseLine(nodes, dependencies);
+        lineStart = lineEnd + 1;
+    }
+    if (parsed && nodes.size() == 0) {
+        cerr << "The configuration file is empty.\n";
+        parsed = false;
+    }
+    if (parsed && !resolveDeps(dependencies)) {
+        parsed = false;
+    }
+    if (parsed) {
+        nodes.build(dependencies);
+    }
+    return parsed;
+}
+
+// split the line on spaces and tabs into views of the mapping
+void ConfigParser::tokenize(const char* begin, const char* end) {
+    tokens.clear();
+    const char* c = begin;
+    while (c < end) {
+        while (c < end && (*c == ' ' || *c == '\t' || *c == '\r')) {
+            c++;
+        }
+        const char* start = c;
+        while (c < end && *c != ' ' && *c != '\t' && *c != '\r') {
+            c++;
+        }
+        if (c > start) {
+            tokens.push_back(string_view(start, c - start));
+        }
+    }
+}
+
+bool ConfigParser::parseLine(NodeStore &nodes, Csr &dependencies) {
+    if (tokens.size() <= DURATION_TOKEN) {
+        return error(tokens[0], "Expected a node name, value and duration.");
+    }
+    NodeId id = nodes.size();
+    int symbol;
+    string_view name = tokens[NAME_TOKEN];
+    if (!parseName(name, symbol)) {
+        return false;
+    }
+    if (symbolNodes[symbol] != -1) {
+        return error(name, "Node '" + string(name) + "' is defined more than once.");
+    }
+    symbolNodes[symbol] = id;
+    int value, duration;
+    if (!parseInteger(tokens[VALUE_TOKEN], value)) {
+        return error(tokens[VALUE_TOKEN],
+                     "Value '" + string(tokens[VALUE_TOKEN]) + "' must be an integer.");
+    }
+    if (!parseInteger(tokens[DURATION_TOKEN], duration) || duration < 0) {
+        return error(tokens[DURATION_TOKEN],
+                     "Duration '" + string(tokens[DURATION_TOKEN]) + "' must be a nonnegative integer.");
+    }
+    // dependencies are stored as symbols until every node is defined
+    size_t i = DEP_TOKEN;
+    for (; i < tokens.size() && tokens[i] != EQUAL_SIGN; i++) {
+        if (!parseName(tokens[i], symbol)) {
+            return false;
+        }
+        dependencies.indices.push_back(symbol);
+    }
+    dependencies.endRow();
+    Expression expression;
+    if (i < tokens.size() && !parseExpr(i, id, expression)) {
+        return false;
+    }
+    nodes.addNode(name, duration, value, expression);
+    return true;
+}
+
+bool ConfigParser::parseName(string_view name, int &symbol) {
+    if (!isNodeName(name)) {
+        return error(name, "Node '" + string(name)
+                     + "' must be a name of letters, digits and underscores.");
+    }
+    symbol = internName(name);
+    return true;
+}
+
+// FNV-1a
+size_t hashName(string_view name) {
+    size_t hash = 14695981039346656037UL;
+    for (size_t i = 0, max = name.length(); i < max; i++) {
+        hash = (hash ^ (unsigned char) name[i]) * 1099511628211UL;
+    }
+    return hash;
+}
+
+int ConfigParser::internName(string_view name) {
+    // keep the table at most half full
+    if (symbolNames.size() * 2 >= symbolTable.size()) {
+        growSymbolTable();
+    }
+    size_t mask = symbolTable.size() - 1;
+    size_t slot = hashName(name) & mask;
+    while (symbolTable[slot] != -1) {
+        if (symbolNames[symbolTable[slot]] == name) {
+            return symbolTable[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    int symbol = symbolNames.size();
+    symbolTable[slot] = symbol;
+    symbolNodes.push_back(-1);
+    symbolNames.push_back(name);
+    symbolLines.push_back(lineNumber);
+    symbolColumns.push_back(name.data() - lineStart + 1);
+    return symbol;
+}
+
+void ConfigParser::growSymbolTable() {
+    size_t capacity = max((size_t) 1024, symbolTable.size() * 2);
+    symbolTable.assign(capacity, -1);
+    for (size_t symbol = 0, max = symbolNames.size(); symbol < max; symbol++) {
+        size_t slot = hashName(symbolNames[symbol]) & (capacity - 1);
+        while (symbolTable[slot] != -1) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        symbolTable[slot] = symbol;
+    }
+}
+
+// compile the symbols after the equal sign at the given token
+bool ConfigParser::parseExpr(size_t equalSign, NodeId id, Expression &expression) {
+    int depth = 0;
+    expression.code.reserve(tokens.size() - equalSign - 1);
+    for (size_t i = equalSign + 1; i < tokens.size(); i++) {
+        const char* reason = appendSymbol(tokens[i], id, expression, depth);
+        if (reason) {
+            return error(tokens[i], "Symbol '" + string(tokens[i]) + "' " + reason + ".");
+        }
+    }
+    const char* reason = finishExpr(expression, depth);
+    if (reason) {
+        return error(tokens[equalSign], string("The expression ") + reason + ".");
+    }
+    return true;
+}
+
+// replace the symbols of the dependencies with the ids of their nodes
+bool ConfigParser::resolveDeps(Csr &dependencies) {
+    for (size_t i = 0, max = dependencies.indices.size(); i < max; i++) {
+        int symbol = dependencies.indices[i];
+        if (symbolNodes[symbol] == -1) {
+            return error(symbolLines[symbol], symbolColumns[symbol],
+                         "Node '" + string(symbolNames[symbol]) + "' is not defined.");
+        }
+        dependencies.indices[i] = symbolNodes[symbol];
+    }
+    return true;
+}
+
+bool ConfigParser::error(string_view at, string message) {
+    return error(lineNumber, at.data() - lineStart + 1, message);
+}
+
+bool ConfigParser::error(int line, int column, string message) {
+    cerr << fileName << ":" << line << ":" << column << ": " << message << "\n";
+    return false;
+}
+
+// node names are a letter or underscore followed by letters, digits and
+// underscores
+bool isNodeName(string_view name) {
+    bool valid = !name.empty() && (isalpha(name[0]) || name[0] == '_');
+    for (size_t i = 1, max = name.length(); valid && i < max; i++) {
+        valid = isalnum(name[i]) || name[i] == '_';
+    }
+    return valid;
+}
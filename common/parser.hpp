@@ -0,0 +1,49 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include "node.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// parses a configuration file in place from a read-only mapping of it,
+// validating each line and adding its node to the store in the same pass
+class ConfigParser {
+    public:
+        ConfigParser(std::string);
+        ConfigParser(std::string, std::string_view text);
+        ~ConfigParser();
+        bool parse(NodeStore &nodes);
+    private:
+        std::string fileName;
+        bool mapped; // the text is a mapping of the file instead of given
+        int fd;
+        const char* data;
+        size_t size;
+        int lineNumber;
+        const char* lineStart;
+        std::vector<std::string_view> tokens; // tokens of the current line
+        // node names are interned to symbols as they are seen, a dependency
+        // may name a node that is defined further down. the open addressing
+        // table holds the symbol in each slot or -1 for an empty slot.
+        std::vector<int> symbolTable;
+        std::vector<NodeId> symbolNodes; // node defined by each symbol or -1
+        std::vector<std::string_view> symbolNames;
+        std::vector<int> symbolLines; // where each symbol was first seen
+        std::vector<int> symbolColumns;
+
+        bool mapFile();
+        void tokenize(const char*, const char*);
+        bool parseLine(NodeStore &nodes, Csr &dependencies);
+        bool parseName(std::string_view, int &symbol);
+        int internName(std::string_view);
+        void growSymbolTable();
+        bool parseExpr(size_t, NodeId, Expression &expression);
+        bool resolveDeps(Csr &dependencies);
+        bool error(std::string_view at, std::string message);
+        bool error(int line, int column, std::string message);
+};
+
+bool isNodeName(std::string_view);
+
+#endif
@@ -0,0 +1,385 @@
+// Dylan Richardson
+#include "partition.hpp"
+#include "scheduler.hpp"
+#include "node.hpp"
+#include "output.hpp"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+PartitionLink::PartitionLink(const NodeStore &nodes, const vector<int> &partitions,
+                             int partition, const vector<int> &peers)
+    : peers(peers), peerMutexes(peers.size()), targetOffsets(1, 0), messages(0),
+      scheduler(NULL), receiving(false) {
+    for (size_t i = 0, max = peerMutexes.size(); i < max; i++) {
+        sem_init(&peerMutexes[i], 0, 1);
+    }
+    vector<bool> seen(peers.size(), false);
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        if (partitions[i] == partition) {
+            for (NodeId next : nodes.getNextNodes(i)) {
+                int target = partitions[next];
+                if (target != partition && !seen[target]) {
+                    seen[target] = true;
+                    targets.push_back(target);
+                }
+            }
+            for (int j = targetOffsets.back(), end = targets.size(); j < end; j++) {
+                seen[targets[j]] = false;
+            }
+        }
+        targetOffsets.push_back(targets.size());
+    }
+}
+
+PartitionLink::~PartitionLink() {
+    finish();
+    for (size_t i = 0, max = peers.size(); i < max; i++) {
+        sem_destroy(&peerMutexes[i]);
+        if (peers[i] != -1) {
+            close(peers[i]);
+        }
+    }
+}
+
+// send a node completed in this process to every process waiting on it
+void PartitionLink::send(NodeId id, int value) {
+    PartitionMessage message = { id, value };
+    for (int i = targetOffsets[id], end = targetOffsets[id + 1]; i < end; i++) {
+        int target = targets[i];
+        sem_wait(&peerMutexes[target]);
+        if (!writeFully(peers[target], &message, sizeof(message))) {
+            cerr << "Failed to send node " << id << " to process " << target << ".\n";
+        }
+        sem_post(&peerMutexes[target]);
+    }
+    messages += targetOffsets[id + 1] - targetOffsets[id];
+}
+
+// complete the nodes the other processes send until all of them are done
+void PartitionLink::start(Scheduler* scheduler) {
+    this->scheduler = scheduler;
+    if (pthread_create(&receiver, NULL, _runReceiver, (void*) this)) {
+        cerr << "Failed to create the partition receiver thread.\n";
+        return;
+    }
+    receiving = true;
+}
+
+// once every node of this process is done nothing more is sent, so each
+// other process sees the end of its socket
+void PartitionLink::finish() {
+    for (size_t i = 0, max = peers.size(); i < max; i++) {
+        if (peers[i] != -1) {
+            shutdown(peers[i], SHUT_WR);
+        }
+    }
+    if (receiving && pthread_join(receiver, NULL)) {
+        cerr << "Failed to join the partition receiver thread.\n";
+    }
+    receiving = false;
+}
+
+long PartitionLink::getMessages() {
+    return messages;
+}
+
+void* PartitionLink::_runReceiver(void* context) {
+    ((PartitionLink*) context)->runReceiver();
+    return NULL;
+}
+
+void PartitionLink::runReceiver() {
+    vector<struct pollfd> polls(peers.size());
+    int open = 0;
+    for (size_t i = 0, max = peers.size(); i < max; i++) {
+        polls[i].fd = peers[i];
+        polls[i].events = POLLIN;
+        open += peers[i] != -1;
+    }
+    // a read may end in the middle of a message, its start is kept for the next
+    vector<vector<char> > pending(peers.size());
+    char buffer[4096];
+    while (open > 0) {
+        if (poll(polls.data(), polls.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "Failed to wait for the other processes.\n";
+            return;
+        }
+        for (size_t i = 0, max = polls.size(); i < max; i++) {
+            if (polls[i].fd == -1 || !polls[i].revents) {
+                continue;
+            }
+            ssize_t length = read(peers[i], buffer, sizeof(buffer));
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            if (length <= 0) {
+                polls[i].fd = -1;
+                open--;
+                continue;
+            }
+            vector<char> &bytes = pending[i];
+            bytes.insert(bytes.end(), buffer, buffer + length);
+            size_t offset = 0;
+            for (; offset + sizeof(PartitionMessage) <= bytes.size();
+                    offset += sizeof(PartitionMessage)) {
+                PartitionMessage message;
+                memcpy(&message, bytes.data() + offset, sizeof(message));
+                scheduler->completeRemote(message.node, message.value);
+            }
+            bytes.erase(bytes.begin(), bytes.begin() + offset);
+        }
+    }
+}
+
+// a dependency in another partition of the same group, such as another
+// worker on the same NUMA node, counts for this much of one in the partition
+const double GROUP_WEIGHT = 0.5;
+
+vector<int> partitionGraph(const NodeStore &nodes, const vector<NodeId> &order, int parts) {
+    vector<int> groups(parts);
+    for (int i = 0; i < parts; i++) {
+        groups[i] = i;
+    }
+    return partitionGraph(nodes, order, groups);
+}
+
+// stream the nodes in topological order and put each in the partition
+// holding most of its dependencies, weighed down as the partition fills so
+// that every partition ends up with about the same number of nodes. chains
+// and diamonds stay together until their partition is full, and then
+// spill to a partition of the same group.
+vector<int> partitionGraph(const NodeStore &nodes, const vector<NodeId> &order,
+                           const vector<int> &groups) {
+    int parts = groups.size();
+    int capacity = (nodes.size() + parts - 1) / parts;
+    vector<int> partitions(nodes.size(), -1);
+    vector<int> sizes(parts, 0);
+    vector<int> shared(parts, 0); // dependencies of the node in each partition
+    vector<int> groupShared(*max_element(groups.begin(), groups.end()) + 1, 0);
+    for (NodeId id : order) {
+        for (NodeId dep : nodes.getDependencies(id)) {
+            shared[partitions[dep]]++;
+            groupShared[groups[partitions[dep]]]++;
+        }
+        int best = -1;
+        double bestScore = 0;
+        for (int i = 0; i < parts; i++) {
+            if (sizes[i] >= capacity) {
+                continue;
+            }
+            double near = shared[i] + GROUP_WEIGHT * (groupShared[groups[i]] - shared[i]);
+            double score = near * (1.0 - (double) sizes[i] / capacity);
+            if (best == -1 || score > bestScore
+                    || (score == bestScore && sizes[i] < sizes[best])) {
+                best = i;
+                bestScore = score;
+            }
+        }
+        partitions[id] = best;
+        sizes[best]++;
+        for (NodeId dep : nodes.getDependencies(id)) {
+            shared[partitions[dep]] = 0;
+            groupShared[groups[partitions[dep]]] = 0;
+        }
+    }
+    return partitions;
+}
+
+// run one partition in a child process and send its results to the parent
+void runPartition(Scheduler* scheduler, const vector<int> &partitions, int partition,
+                  const vector<int> &peers, int parent, OutputFormat format) {
+    PartitionLink* link = new PartitionLink(scheduler->getNodes(), partitions, partition, peers);
+    ResultWriter* output = NULL;
+    if (format != OUTPUT_NONE) {
+        output = new ResultWriter(scheduler->getNodes(), OUTPUT_BINARY, parent, true);
+        scheduler->setOutput(output);
+    }
+    scheduler->setPartition(partitions, partition, link);
+    GraphResult result = scheduler->run();
+    link->finish();
+    // the writer is flushed before the reply follows its last frame
+    delete output;
+    PartitionReply reply;
+    reply.total = result.value;
+    reply.duration = result.duration;
+    reply.messages = link->getMessages();
+    reply.bytes = reply.messages * sizeof(PartitionMessage);
+    delete link;
+    int32_t end = 0;
+    bool sent = writeFully(parent, &end, sizeof(end)) && writeFully(parent, &reply, sizeof(reply));
+    _exit(sent ? 0 : 1);
+}
+
+// print the results every child sends through the scheduler's output and
+// add up their replies
+bool collectPartitions(Scheduler* scheduler, const vector<int> &links, GraphResult &result,
+                       PartitionStats &stats) {
+    vector<struct pollfd> polls(links.size());
+    vector<bool> started(links.size(), false); // the first frame opens with the header
+    for (size_t i = 0, max = links.size(); i < max; i++) {
+        polls[i].fd = links[i];
+        polls[i].events = POLLIN;
+    }
+    result.value = 0;
+    result.duration = 0;
+    size_t replies = 0;
+    vector<char> frame;
+    while (replies < links.size()) {
+        if (poll(polls.data(), polls.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        for (size_t i = 0, max = polls.size(); i < max; i++) {
+            if (polls[i].fd == -1 || !polls[i].revents) {
+                continue;
+            }
+            int32_t length;
+            if (!readFully(links[i], &length, sizeof(length))) {
+                cerr << "Process " << i << " of the partitioned run failed.\n";
+                return false;
+            }
+            if (length == 0) {
+                PartitionReply reply;
+                if (!readFully(links[i], &reply, sizeof(reply))) {
+                    cerr << "Process " << i << " of the partitioned run failed.\n";
+                    return false;
+                }
+                result.value += reply.total;
+                result.duration = std::max(result.duration, reply.duration);
+                stats.messages += reply.messages;
+                stats.bytes += reply.bytes;
+                polls[i].fd = -1;
+                replies++;
+                continue;
+            }
+            frame.resize(length);
+            if (!readFully(links[i], frame.data(), length)) {
+                cerr << "Process " << i << " of the partitioned run failed.\n";
+                return false;
+            }
+            size_t offset = started[i] ? 0 : sizeof(OUTPUT_MAGIC) + sizeof(OUTPUT_VERSION);
+            started[i] = true;
+            for (; offset + sizeof(ResultRecord) <= frame.size(); offset += sizeof(ResultRecord)) {
+                ResultRecord record;
+                memcpy(&record, frame.data() + offset, sizeof(record));
+                scheduler->printRemote(record.node, record.value, record.time);
+            }
+        }
+    }
+    return true;
+}
+
+// fork a process for each partition of the graph and wait for all of them.
+// the scheduler must not have run yet, each child runs its own copy of it.
+bool runPartitioned(Scheduler* scheduler, int processes, OutputFormat format,
+                    GraphResult &result, PartitionStats &stats) {
+    const NodeStore &nodes = scheduler->getNodes();
+    vector<int> partitions = partitionGraph(nodes, scheduler->getTopologicalOrder(), processes);
+    stats.edges = 0;
+    stats.cutEdges = 0;
+    stats.messages = 0;
+    stats.bytes = 0;
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        for (NodeId next : nodes.getNextNodes(i)) {
+            stats.edges++;
+            stats.cutEdges += partitions[i] != partitions[next];
+        }
+    }
+    // a socket between every two processes and one from each to the parent
+    vector<vector<int> > peers(processes, vector<int>(processes, -1));
+    vector<int> links(processes, -1);
+    vector<int> childLinks(processes, -1);
+    bool connected = true;
+    for (int i = 0; i < processes && connected; i++) {
+        int fds[2];
+        connected = !socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        if (connected) {
+            links[i] = fds[0];
+            childLinks[i] = fds[1];
+        }
+        for (int j = i + 1; j < processes && connected; j++) {
+            connected = !socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+            if (connected) {
+                peers[i][j] = fds[0];
+                peers[j][i] = fds[1];
+            }
+        }
+    }
+    if (!connected) {
+        cerr << "Could not connect the processes of the partitioned run.\n";
+    }
+    // anything buffered would be printed again by every child
+    cout << flush;
+    fflush(stdout);
+    vector<pid_t> children;
+    for (int i = 0; i < processes && connected; i++) {
+        pid_t child = fork();
+        if (child == -1) {
+            cerr << "Failed to fork process " << i << " of the partitioned run.\n";
+            connected = false;
+            break;
+        }
+        if (child == 0) {
+            // only its own sockets stay open, so a process sees the end of
+            // each of them once the other side is done
+            for (int j = 0; j < processes; j++) {
+                if (links[j] != -1) {
+                    close(links[j]);
+                }
+                if (j != i && childLinks[j] != -1) {
+                    close(childLinks[j]);
+                }
+                for (int k = 0; k < processes; k++) {
+                    if (j != i && peers[j][k] != -1) {
+                        close(peers[j][k]);
+                    }
+                }
+            }
+            runPartition(scheduler, partitions, i, peers[i], childLinks[i], format);
+        }
+        children.push_back(child);
+    }
+    for (int i = 0; i < processes; i++) {
+        if (childLinks[i] != -1) {
+            close(childLinks[i]);
+        }
+        for (int j = 0; j < processes; j++) {
+            if (peers[i][j] != -1) {
+                close(peers[i][j]);
+            }
+        }
+    }
+    bool ran = connected && collectPartitions(scheduler, links, result, stats);
+    for (size_t i = 0, max = children.size(); i < max; i++) {
+        if (!ran) {
+            kill(children[i], SIGTERM);
+        }
+        int status;
+        waitpid(children[i], &status, 0);
+        ran = ran && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    for (int i = 0; i < processes; i++) {
+        if (links[i] != -1) {
+            close(links[i]);
+        }
+    }
+    return ran;
+}
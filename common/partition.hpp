@@ -0,0 +1,71 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "node.hpp"
+#include "output.hpp"
+#include "scheduler.hpp"
+#include <atomic>
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+
+// a graph split over processes on one machine. every process forks with
+// the whole graph and runs the nodes of its partition. a socket between
+// every two processes carries the nodes completed in one to the other when
+// it runs one of their successors. the results of each process go to the
+// parent as frames of binary output, then an int32 0 and a PartitionReply.
+
+// a completed node, sent once to each process running a successor of it
+struct PartitionMessage {
+    int32_t node;
+    int32_t value;
+};
+
+struct PartitionReply {
+    int32_t total; // of the nodes of the process
+    int32_t duration;
+    int64_t messages; // sent to the other processes
+    int64_t bytes;
+};
+
+struct PartitionStats {
+    int edges;
+    int cutEdges; // edges between nodes of two partitions
+    long messages;
+    long bytes;
+};
+
+// the sockets from one process to each of the others
+class PartitionLink {
+    public:
+        PartitionLink(const NodeStore &nodes, const std::vector<int> &partitions, int partition,
+                      const std::vector<int> &peers);
+        ~PartitionLink();
+        void send(NodeId, int value);
+        void start(Scheduler*);
+        void finish();
+        long getMessages();
+        static void* _runReceiver(void*);
+    private:
+        std::vector<int> peers; // socket to each process, -1 for this one
+        std::vector<sem_t> peerMutexes; // guard each socket against interleaved sends
+        // the other partitions running a successor of each node of this one
+        std::vector<int> targetOffsets;
+        std::vector<int> targets;
+        std::atomic<long> messages;
+        Scheduler* scheduler;
+        bool receiving;
+        pthread_t receiver;
+
+        void runReceiver();
+};
+
+std::vector<int> partitionGraph(const NodeStore &nodes, const std::vector<NodeId> &order,
+                                int parts);
+std::vector<int> partitionGraph(const NodeStore &nodes, const std::vector<NodeId> &order,
+                                const std::vector<int> &groups);
+bool runPartitioned(Scheduler*, int processes, OutputFormat, GraphResult &result,
+                    PartitionStats &stats);
+
+#endif
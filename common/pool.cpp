@@ -0,0 +1,389 @@
+// Dylan Richardson
+#include "pool.hpp"
+#include "deque.hpp"
+#include "scheduler.hpp"
+#include "topology.hpp"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <unistd.h>
+
+using namespace std;
+
+// the worker running on this thread, if any
+static __thread Worker* CURRENT_WORKER = NULL;
+
+ReadyQueue::ReadyQueue(QueuePolicy policy) {
+    this->policy = policy;
+    this->pushed = 0;
+}
+
+bool ReadyQueue::empty() {
+    return entries.empty();
+}
+
+void ReadyQueue::push(Noduler noduler) {
+    Entry entry = { noduler, pushed++ };
+    entries.push_back(entry);
+    if (policy == POLICY_CRITICAL) {
+        push_heap(entries.begin(), entries.end(), runsAfter);
+    }
+}
+
+Noduler ReadyQueue::pop() {
+    Noduler noduler;
+    if (policy == POLICY_LIFO) {
+        noduler = entries.back().noduler;
+        entries.pop_back();
+    } else if (policy == POLICY_CRITICAL) {
+        pop_heap(entries.begin(), entries.end(), runsAfter);
+        noduler = entries.back().noduler;
+        entries.pop_back();
+    } else {
+        noduler = entries.front().noduler;
+        entries.pop_front();
+    }
+    return noduler;
+}
+
+// the heap keeps the highest priority on top, ties go to the older entry
+bool ReadyQueue::runsAfter(const Entry &a, const Entry &b) {
+    if (a.noduler.priority != b.noduler.priority) {
+        return a.noduler.priority < b.noduler.priority;
+    }
+    return a.sequence > b.sequence;
+}
+
+WorkerInbox::WorkerInbox(QueuePolicy policy) : local(policy), remote(policy) {
+    sem_init(&mutex, 0, 1);
+    sem_init(&count, 0, 0);
+}
+
+WorkerInbox::~WorkerInbox() {
+    sem_destroy(&mutex);
+    sem_destroy(&count);
+}
+
+WorkerPool::WorkerPool(int threadCount, PoolBackend backend, QueuePolicy policy)
+        : queue(policy) {
+    this->backend = backend;
+    sem_init(&queueMutex, 0, 1);
+    sem_init(&queueCount, 0, 0);
+    sem_init(&idleMutex, 0, 1);
+    sleepers = 0;
+    threads.resize(threadCount);
+    workers.resize(threadCount);
+    if (backend == POOL_PINNED) {
+        placeWorkers(readTopology(), threadCount, cpus, groups);
+    } else {
+        groups.assign(threadCount, 0);
+    }
+    for (int i = 0; i < threadCount; i++) {
+        workers[i] = new Worker;
+        workers[i]->pool = this;
+        workers[i]->index = i;
+        workers[i]->deque = backend == POOL_STEAL ? new WorkDeque : NULL;
+        workers[i]->inbox = backend == POOL_PINNED ? new WorkerInbox(policy) : NULL;
+        workers[i]->parked = false;
+        sem_init(&workers[i]->wake, 0, 0);
+    }
+    for (int i = 0; i < threadCount; i++) {
+        startThread(i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    // one empty noduler per worker tells it to exit
+    for (size_t i = 0, max = threads.size(); i < max; i++) {
+        submit(Noduler(), i);
+    }
+    for (size_t i = 0, max = threads.size(); i < max; i++) {
+        if (pthread_join(threads[i], NULL)) {
+            cerr << "Failed to join worker thread " << i << ".\n";
+        }
+        delete workers[i]->deque;
+        delete workers[i]->inbox;
+        sem_destroy(&workers[i]->wake);
+        delete workers[i];
+    }
+    sem_destroy(&queueMutex);
+    sem_destroy(&queueCount);
+    sem_destroy(&idleMutex);
+}
+
+int WorkerPool::getThreadCount() {
+    return threads.size();
+}
+
+PoolBackend WorkerPool::getBackend() {
+    return backend;
+}
+
+// the NUMA node of each worker, all on node 0 unless the pool is pinned
+const vector<int> &WorkerPool::getWorkerGroups() {
+    return groups;
+}
+
+void WorkerPool::startThread(int i) {
+    if (pthread_create(&threads[i], NULL, _runWorker, (void*) workers[i])) {
+        cerr << "Failed to create worker thread " << i << ".\n";
+        return;
+    }
+    if (backend == POOL_PINNED) {
+        pinThread(i);
+    }
+}
+
+void WorkerPool::pinThread(int i) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[i], &set);
+    if (pthread_setaffinity_np(threads[i], sizeof(set), &set)) {
+        cerr << "Failed to pin worker thread " << i << " to cpu " << cpus[i] << ".\n";
+    }
+}
+
+void* WorkerPool::_runWorker(void* context) {
+    Worker* worker = (Worker*) context;
+    CURRENT_WORKER = worker;
+    worker->pool->runWorker(worker);
+    return NULL;
+}
+
+void WorkerPool::runWorker(Worker* worker) {
+    Noduler noduler;
+    while ((noduler = take(worker)).scheduler) {
+        Scheduler::_runNode(&noduler);
+    }
+}
+
+void WorkerPool::submit(Noduler noduler) {
+    if (backend == POOL_PINNED) {
+        submit(noduler, noduler.node < 0 ? 0 : noduler.node % workers.size());
+        return;
+    }
+    Worker* worker = CURRENT_WORKER;
+    if (backend == POOL_STEAL && noduler.scheduler
+            && worker && worker->pool == this) {
+        // successors made ready by a worker stay on that worker
+        worker->deque->push(noduler);
+    } else {
+        sem_wait(&queueMutex);
+        queue.push(noduler);
+        sem_post(&queueMutex);
+    }
+    if (backend == POOL_STEAL) {
+        wakeIdle();
+    } else {
+        sem_post(&queueCount);
+    }
+}
+
+// run the noduler on the given worker of a pinned pool, any worker of
+// the others
+void WorkerPool::submit(Noduler noduler, int worker) {
+    if (backend != POOL_PINNED) {
+        submit(noduler);
+        return;
+    }
+    WorkerInbox* inbox = workers[worker]->inbox;
+    if (CURRENT_WORKER == workers[worker]) {
+        inbox->local.push(noduler);
+        return;
+    }
+    sem_wait(&inbox->mutex);
+    inbox->remote.push(noduler);
+    sem_post(&inbox->mutex);
+    sem_post(&inbox->count);
+}
+
+// submit nodes that are ready at the same time. every one is queued before
+// any worker is woken, so the first worker to take one already chooses
+// among all of them by the policy. workers holds the worker of each node
+// for a pinned pool and is empty for the others
+void WorkerPool::submit(const vector<Noduler> &nodulers, const vector<int> &workers) {
+    if (backend == POOL_PINNED) {
+        vector<WorkerInbox*> posted;
+        for (size_t i = 0, max = nodulers.size(); i < max; i++) {
+            WorkerInbox* inbox = this->workers[workers[i]]->inbox;
+            if (CURRENT_WORKER == this->workers[workers[i]]) {
+                inbox->local.push(nodulers[i]);
+                continue;
+            }
+            sem_wait(&inbox->mutex);
+            inbox->remote.push(nodulers[i]);
+            sem_post(&inbox->mutex);
+            posted.push_back(inbox);
+        }
+        for (size_t i = 0, max = posted.size(); i < max; i++) {
+            sem_post(&posted[i]->count);
+        }
+        return;
+    }
+    sem_wait(&queueMutex);
+    for (size_t i = 0, max = nodulers.size(); i < max; i++) {
+        queue.push(nodulers[i]);
+    }
+    sem_post(&queueMutex);
+    for (size_t i = 0, max = nodulers.size(); i < max; i++) {
+        if (backend == POOL_STEAL) {
+            wakeIdle();
+        } else {
+            sem_post(&queueCount);
+        }
+    }
+}
+
+Noduler WorkerPool::take(Worker* worker) {
+    if (backend == POOL_PINNED) {
+        return takePlaced(worker);
+    }
+    if (backend == POOL_STEAL) {
+        return takeStealing(worker);
+    }
+    // every submitted noduler posts the count once, so after the wait
+    // there is a noduler reserved for this worker in the queue
+    sem_wait(&queueCount);
+    Noduler noduler;
+    takeShared(noduler);
+    return noduler;
+}
+
+// a stealing worker runs its own nodes first, then those submitted from
+// off the pool, then steals. only once all three are empty does it park.
+Noduler WorkerPool::takeStealing(Worker* worker) {
+    Noduler noduler;
+    while (!findWork(worker, noduler)) {
+        // the worker is on the idle list before it looks one last time, so
+        // a node submitted after that look finds it there and wakes it
+        sem_wait(&idleMutex);
+        worker->parked = true;
+        idleWorkers.push_back(worker);
+        sleepers.fetch_add(1);
+        sem_post(&idleMutex);
+        if (findWork(worker, noduler)) {
+            unpark(worker);
+            break;
+        }
+        sem_wait(&worker->wake);
+    }
+    return noduler;
+}
+
+bool WorkerPool::findWork(Worker* worker, Noduler &noduler) {
+    return worker->deque->pop(noduler) || takeShared(noduler) || takeStolen(worker, noduler);
+}
+
+// take a worker that found a node after all back off the idle list. if a
+// submitter already took it off, its wake is spent on a worker that is no
+// longer idle, so it is waited out and handed on to another idle worker
+void WorkerPool::unpark(Worker* worker) {
+    sem_wait(&idleMutex);
+    bool woken = !worker->parked;
+    if (!woken) {
+        idleWorkers.erase(find(idleWorkers.begin(), idleWorkers.end(), worker));
+        worker->parked = false;
+        sleepers.fetch_sub(1);
+    }
+    sem_post(&idleMutex);
+    if (woken) {
+        sem_wait(&worker->wake);
+        wakeIdle();
+    }
+}
+
+// wake one parked worker for a node just submitted. while every worker is
+// busy this only reads the count, which no one writes
+void WorkerPool::wakeIdle() {
+    // the submitted node must be visible before the count is read, the
+    // parking worker orders the other way round
+    atomic_thread_fence(memory_order_seq_cst);
+    if (sleepers.load(memory_order_relaxed) == 0) {
+        return;
+    }
+    Worker* idle = NULL;
+    sem_wait(&idleMutex);
+    if (!idleWorkers.empty()) {
+        idle = idleWorkers.back();
+        idleWorkers.pop_back();
+        idle->parked = false;
+        sleepers.fetch_sub(1);
+    }
+    sem_post(&idleMutex);
+    if (idle) {
+        sem_post(&idle->wake);
+    }
+}
+
+// the nodes a pinned worker made ready itself come first, they are the
+// most likely to find their inputs in its cache
+Noduler WorkerPool::takePlaced(Worker* worker) {
+    WorkerInbox* inbox = worker->inbox;
+    if (!inbox->local.empty()) {
+        return inbox->local.pop();
+    }
+    sem_wait(&inbox->count);
+    sem_wait(&inbox->mutex);
+    Noduler noduler = inbox->remote.pop();
+    sem_post(&inbox->mutex);
+    return noduler;
+}
+
+bool WorkerPool::takeShared(Noduler &noduler) {
+    sem_wait(&queueMutex);
+    bool found = !queue.empty();
+    if (found) {
+        noduler = queue.pop();
+    }
+    sem_post(&queueMutex);
+    return found;
+}
+
+bool WorkerPool::takeStolen(Worker* worker, Noduler &noduler) {
+    for (size_t i = 1, max = workers.size(); i < max; i++) {
+        Worker* victim = workers[(worker->index + i) % max];
+        if (victim->deque->steal(noduler)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the index of the worker running on this thread or -1 off the pool
+int currentWorkerIndex() {
+    return CURRENT_WORKER ? CURRENT_WORKER->index : -1;
+}
+
+int defaultThreadCount() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? cores : 1;
+}
+
+bool backendFromString(string name, PoolBackend &backend) {
+    if (name == "shared") {
+        backend = POOL_SHARED;
+    } else if (name == "steal") {
+        backend = POOL_STEAL;
+    } else if (name == "pinned") {
+        backend = POOL_PINNED;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool policyFromString(string name, QueuePolicy &policy) {
+    if (name == "fifo") {
+        policy = POLICY_FIFO;
+    } else if (name == "lifo") {
+        policy = POLICY_LIFO;
+    } else if (name == "critical") {
+        policy = POLICY_CRITICAL;
+    } else {
+        return false;
+    }
+    return true;
+}
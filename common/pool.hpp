@@ -0,0 +1,122 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+
+class Scheduler;
+class WorkDeque;
+
+struct Noduler {
+    Scheduler* scheduler;
+    int node; // the id of the node in the store of the scheduler
+    int priority; // nodes with a higher priority run first under POLICY_CRITICAL
+    Noduler() : scheduler(NULL), node(-1), priority(0) {}
+    Noduler(Scheduler* _scheduler, int _node, int _priority = 0)
+        : scheduler(_scheduler), node(_node), priority(_priority) {}
+};
+
+enum PoolBackend {
+    POOL_SHARED, // one run queue shared by every worker
+    POOL_STEAL,  // a work-stealing deque per worker
+    POOL_PINNED  // workers pinned to cpus, each running the nodes placed on it
+};
+
+enum QueuePolicy {
+    POLICY_FIFO,    // the node that became ready first
+    POLICY_LIFO,    // the node that became ready last
+    POLICY_CRITICAL // the node with the longest path left to a sink
+};
+
+// the nodes that are ready to run, taken in the order of a policy
+class ReadyQueue {
+    public:
+        ReadyQueue(QueuePolicy);
+        bool empty();
+        void push(Noduler);
+        Noduler pop();
+    private:
+        struct Entry {
+            Noduler noduler;
+            long sequence;
+        };
+        QueuePolicy policy;
+        long pushed;
+        std::deque<Entry> entries; // a heap under POLICY_CRITICAL
+
+        static bool runsAfter(const Entry &a, const Entry &b);
+};
+
+class WorkerPool;
+
+// the nodes placed on a pinned worker. those it makes ready itself need no
+// synchronization, only nodes made ready by other threads go through the
+// guarded queue.
+struct WorkerInbox {
+    ReadyQueue local; // only the worker touches it
+    ReadyQueue remote;
+    sem_t mutex; // guards remote
+    sem_t count; // number of nodes waiting in remote
+    WorkerInbox(QueuePolicy);
+    ~WorkerInbox();
+};
+
+struct Worker {
+    WorkerPool* pool;
+    int index;
+    WorkDeque* deque;
+    WorkerInbox* inbox;
+    bool parked; // on the idle list of a stealing pool
+    sem_t wake; // posted when a stealing worker is taken off the idle list
+};
+
+// a fixed number of worker threads that run ready nodes
+class WorkerPool {
+    public:
+        WorkerPool(int, PoolBackend, QueuePolicy);
+        ~WorkerPool();
+        void submit(Noduler);
+        void submit(Noduler, int worker);
+        void submit(const std::vector<Noduler> &nodulers, const std::vector<int> &workers);
+        int getThreadCount();
+        PoolBackend getBackend();
+        const std::vector<int> &getWorkerGroups();
+        static void* _runWorker(void*);
+    private:
+        PoolBackend backend;
+        std::vector<pthread_t> threads;
+        std::vector<Worker*> workers;
+        std::vector<int> cpus; // the cpu each pinned worker runs on
+        std::vector<int> groups; // the NUMA node of each pinned worker
+        ReadyQueue queue;
+        sem_t queueMutex; // guards the queue
+        sem_t queueCount; // number of nodes waiting in the queue of a shared pool
+        // stealing workers that found nothing to run, each waits on its
+        // own semaphore so that busy workers never touch a shared count
+        std::vector<Worker*> idleWorkers;
+        sem_t idleMutex; // guards idleWorkers and the parked flags
+        std::atomic<int> sleepers; // size of idleWorkers, read without the lock
+
+        void startThread(int);
+        void pinThread(int);
+        void runWorker(Worker*);
+        Noduler take(Worker*);
+        bool takeShared(Noduler &noduler);
+        bool takeStolen(Worker*, Noduler &noduler);
+        Noduler takePlaced(Worker*);
+        Noduler takeStealing(Worker*);
+        bool findWork(Worker*, Noduler &noduler);
+        void unpark(Worker*);
+        void wakeIdle();
+};
+
+int currentWorkerIndex();
+int defaultThreadCount();
+bool backendFromString(std::string, PoolBackend &backend);
+bool policyFromString(std::string, QueuePolicy &policy);
+
+#endif
@@ -0,0 +1,755 @@
+// Dylan Richardson
+#include "scheduler.hpp"
+#include "node.hpp"
+#include "trace.hpp"
+#include "partition.hpp"
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <sstream>
+#include <pthread.h>
+#include <time.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+using namespace std;
+
+// scenarios evaluated in one traversal of the graph
+const int SCENARIO_CHUNK = 64;
+
+// the scheduler owns the built store
+Scheduler::Scheduler(NodeStore* nodes, int threadCount, PoolBackend backend) {
+    this->nodes = nodes;
+    sortNodes();
+    computeTotalDurations();
+    initScheduler(threadCount, backend);
+}
+
+// a graph whose order and total durations were already computed
+Scheduler::Scheduler(NodeStore* nodes, vector<NodeId> topologicalOrder, int threadCount,
+                     PoolBackend backend) {
+    this->nodes = nodes;
+    this->topologicalOrder = topologicalOrder;
+    initScheduler(threadCount, backend);
+}
+
+void Scheduler::initScheduler(int threadCount, PoolBackend backend) {
+    this->threadCount = threadCount;
+    this->backend = backend;
+    this->policy = POLICY_FIFO;
+    this->pool = NULL;
+    this->outputFormat = OUTPUT_TEXT;
+    this->output = NULL;
+    this->ownsOutput = true;
+    this->partition = 0;
+    this->link = NULL;
+    this->fusion = true;
+    this->vectorLength = 0;
+    this->vectorStride = 0;
+    computeBottomLevels();
+    countdowns.init(this, *nodes);
+    values.assign(nodes->size(), 0);
+}
+
+NodeStore &Scheduler::getNodes() {
+    return *nodes;
+}
+
+// hand the store back to the caller instead of freeing it with the
+// scheduler, which must not run again
+NodeStore* Scheduler::releaseNodes() {
+    NodeStore* released = nodes;
+    nodes = NULL;
+    return released;
+}
+
+const vector<NodeId> &Scheduler::getTopologicalOrder() {
+    return topologicalOrder;
+}
+
+Scheduler::~Scheduler() {
+    // the writer formats node names until it is deleted
+    if (ownsOutput) {
+        delete output;
+    }
+    delete nodes;
+}
+
+// order the nodes so that every node comes after its dependencies, nodes
+// on a cycle never become ready and are left out
+void Scheduler::sortNodes() {
+    vector<int> remaining(nodes->size());
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        remaining[i] = nodes->getDepCount(i);
+        if (remaining[i] == 0) {
+            topologicalOrder.push_back(i);
+        }
+    }
+    for (size_t i = 0; i < topologicalOrder.size(); i++) {
+        for (NodeId next : nodes->getNextNodes(topologicalOrder[i])) {
+            if (--remaining[next] == 0) {
+                topologicalOrder.push_back(next);
+            }
+        }
+    }
+}
+
+bool Scheduler::isAcyclic() {
+    return (int) topologicalOrder.size() == nodes->size();
+}
+
+// the time each node completes is its duration after the latest of its
+// dependencies completes
+void Scheduler::computeTotalDurations() {
+    for (size_t i = 0, max = topologicalOrder.size(); i < max; i++) {
+        NodeId id = topologicalOrder[i];
+        int maxDur = 0;
+        for (NodeId dep : nodes->getDependencies(id)) {
+            maxDur = std::max(maxDur, nodes->getTotalDuration(dep));
+        }
+        nodes->setTotalDuration(id, nodes->getDuration(id) + maxDur);
+    }
+}
+
+// the time from each node starting to the end of the graph, which is the
+// duration of the node and the longest of its successors
+void Scheduler::computeBottomLevels() {
+    bottomLevels.assign(nodes->size(), 0);
+    for (size_t i = topologicalOrder.size(); i-- > 0;) {
+        NodeId id = topologicalOrder[i];
+        int maxLevel = 0;
+        for (NodeId next : nodes->getNextNodes(id)) {
+            maxLevel = std::max(maxLevel, bottomLevels[next]);
+        }
+        bottomLevels[id] = nodes->getDuration(id) + maxLevel;
+    }
+}
+
+void Scheduler::setPolicy(QueuePolicy policy) {
+    this->policy = policy;
+}
+
+void Scheduler::setFusion(bool fusion) {
+    this->fusion = fusion;
+}
+
+void Scheduler::setOutputFormat(OutputFormat format) {
+    if (ownsOutput) {
+        delete output;
+    }
+    output = NULL;
+    ownsOutput = true;
+    outputFormat = format;
+}
+
+// print to a writer that the caller keeps and that formats the names of
+// this scheduler's store
+void Scheduler::setOutput(ResultWriter* output) {
+    if (ownsOutput) {
+        delete this->output;
+    }
+    this->output = output;
+    ownsOutput = false;
+}
+
+// run only the nodes of one partition in this process. the link sends the
+// nodes completed here to the processes running their successors, and
+// completes the nodes of the other processes that this one waits on.
+void Scheduler::setPartition(const vector<int> &partitions, int partition, PartitionLink* link) {
+    this->partitions = partitions;
+    this->partition = partition;
+    this->link = link;
+}
+
+bool Scheduler::isLocal(NodeId id) {
+    return partitions.empty() || partitions[id] == partition;
+}
+
+// the writer thread and its ring are only started once there is something
+// to print, so a scheduler that prints nothing costs neither
+void Scheduler::openOutput() {
+    if (!output && outputFormat != OUTPUT_NONE) {
+        output = new ResultWriter(*nodes, outputFormat);
+    }
+}
+
+// write the total after every node of the run and wait until it is out
+void Scheduler::printResult(GraphResult result) {
+    openOutput();
+    if (output) {
+        output->pushTotal(result.value, result.duration);
+        output->flush();
+    }
+}
+
+// print a node that another process computed
+void Scheduler::printRemote(NodeId id, int value, int time) {
+    openOutput();
+    printComputation(id, value, time);
+}
+
+// no schedule can finish before the critical path, nor before the work of
+// every node is shared out evenly among the workers
+int Scheduler::getLowerBound() {
+    long work = 0;
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        work += nodes->getDuration(i);
+    }
+    return std::max((long) getGraphDuration(), (work + threadCount - 1) / threadCount);
+}
+
+GraphResult Scheduler::run() {
+    WorkerPool* ownPool = new WorkerPool(threadCount, backend, policy);
+    start(ownPool);
+    GraphResult result = wait();
+    delete ownPool;
+    return result;
+}
+
+// start running on a pool that other schedulers may be running on too,
+// the nodes of each carry their own scheduler
+void Scheduler::start(WorkerPool* pool) {
+    this->pool = pool;
+    partialTotals.assign(pool->getThreadCount() + 1, PartialTotal());
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    openOutput();
+    findPrecomputed();
+    placeNodes();
+    fuseChains();
+    countdowns.start();
+    vector<NodeId> ready = completePrecomputed();
+    finishRemoteNodes();
+    // nodes without dependencies are ready immediately, the rest are
+    // submitted by their last predecessor
+    submitRoots(ready);
+    if (link) {
+        link->start(this);
+    }
+}
+
+// wait for every node of the run started last to complete
+GraphResult Scheduler::wait() {
+    countdowns.wait();
+    pool = NULL;
+    // return graph results
+    GraphResult result;
+    result.value = reduceTotals();
+    result.duration = reduceFinishTimes();
+    return result;
+}
+
+// run the graph on a virtual clock instead of sleeping. every worker takes
+// the next ready node of the policy when it is idle and the clock jumps to
+// the next node that completes, so the values and times are those of a real
+// run on threadCount workers without waiting for them
+GraphResult Scheduler::simulate() {
+    partialTotals.assign(1, PartialTotal());
+    openOutput();
+    findPrecomputed();
+    placement.clear();
+    fuseChains();
+    vector<int> remaining(nodes->size());
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        remaining[i] = nodes->getDepCount(i);
+    }
+    for (size_t i = 0, max = topologicalOrder.size(); i < max; i++) {
+        NodeId id = topologicalOrder[i];
+        if (precomputed[id]) {
+            values[id] = nodes->getValue(id, 0);
+            incrementTotal(values[id]);
+            printComputation(id, values[id], 0);
+            for (NodeId next : nodes->getNextNodes(id)) {
+                remaining[next]--;
+            }
+        }
+    }
+    ReadyQueue ready(policy);
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        if (remaining[i] == 0 && !precomputed[i]) {
+            ready.push(Noduler(this, i, bottomLevels[i]));
+        }
+    }
+    // completion events ordered by time, ties by the order the nodes started
+    priority_queue<pair<int, int>, vector<pair<int, int> >, greater<pair<int, int> > > events;
+    vector<NodeId> started;
+    int idle = threadCount;
+    int clock = 0;
+    while (!ready.empty() || !events.empty()) {
+        while (idle > 0 && !ready.empty()) {
+            NodeId id = ready.pop().node;
+            events.push(make_pair(clock + nodes->getDuration(id), started.size()));
+            started.push_back(id);
+            idle--;
+        }
+        clock = events.top().first;
+        NodeId id = started[events.top().second];
+        events.pop();
+        int value = nodes->getValue(id, getDependencyTotal(id));
+        values[id] = value;
+        incrementTotal(value);
+        printComputation(id, value, clock);
+        // the worker goes straight on to the next member of a fused chain
+        NodeId fused = fusedNext.empty() ? -1 : fusedNext[id];
+        if (fused != -1) {
+            remaining[fused]--;
+            events.push(make_pair(clock + nodes->getDuration(fused), started.size()));
+            started.push_back(fused);
+            continue;
+        }
+        idle++;
+        for (NodeId next : nodes->getNextNodes(id)) {
+            if (--remaining[next] == 0) {
+                ready.push(Noduler(this, next, bottomLevels[next]));
+            }
+        }
+    }
+    GraphResult result;
+    result.value = reduceTotals();
+    result.duration = clock;
+    return result;
+}
+
+void Scheduler::setNodeValue(NodeId id, int value) {
+    nodes->setValue(id, value);
+    editedNodes.push_back(id);
+}
+
+void Scheduler::setNodeExpression(NodeId id, Span<Instruction> code) {
+    nodes->setExpression(id, code);
+    editedNodes.push_back(id);
+}
+
+// after a run, evaluate again only the edited nodes and the successors of
+// every node whose value changed, in topological order so that each is
+// evaluated once. nodes whose value did not change are not printed.
+GraphResult Scheduler::recompute() {
+    openOutput();
+    if (topologicalPositions.empty()) {
+        topologicalPositions.resize(nodes->size());
+        for (size_t i = 0, max = topologicalOrder.size(); i < max; i++) {
+            topologicalPositions[topologicalOrder[i]] = i;
+        }
+    }
+    priority_queue<int, vector<int>, greater<int> > pending;
+    vector<bool> queued(nodes->size());
+    for (size_t i = 0, max = editedNodes.size(); i < max; i++) {
+        if (!queued[editedNodes[i]]) {
+            queued[editedNodes[i]] = true;
+            pending.push(topologicalPositions[editedNodes[i]]);
+        }
+    }
+    editedNodes.clear();
+    while (!pending.empty()) {
+        NodeId id = topologicalOrder[pending.top()];
+        pending.pop();
+        int value = nodes->getValue(id, getDependencyTotal(id));
+        if (value == values[id]) {
+            continue;
+        }
+        incrementTotal(value - values[id]);
+        values[id] = value;
+        printComputation(id, value, nodes->getTotalDuration(id));
+        for (NodeId next : nodes->getNextNodes(id)) {
+            if (!queued[next]) {
+                queued[next] = true;
+                pending.push(topologicalPositions[next]);
+            }
+        }
+    }
+    GraphResult result;
+    result.value = reduceTotals();
+    result.duration = getGraphDuration();
+    return result;
+}
+
+// evaluate the scenarios SCENARIO_CHUNK at a time, each chunk in one
+// traversal of the graph in topological order. the values of every node
+// are kept for the chunk since any later node may depend on them
+bool Scheduler::runScenarios(const Scenarios &scenarios, vector<GraphResult> &results) {
+    int count = scenarios.count;
+    map<string, vector<int> >::const_iterator column;
+    size_t found = 0;
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        found += scenarios.columns.count(string(nodes->getName(i)));
+    }
+    if (found != scenarios.columns.size()) {
+        cerr << "The scenarios name nodes that are not in the graph.\n";
+        return false;
+    }
+    vector<int> totals(count, 0);
+    for (int start = 0; start < count; start += SCENARIO_CHUNK) {
+        int lanes = std::min(SCENARIO_CHUNK, count - start);
+        vector<int> chunkValues(nodes->size() * lanes);
+        vector<int> depTotals(lanes);
+        for (size_t i = 0, max = topologicalOrder.size(); i < max; i++) {
+            NodeId id = topologicalOrder[i];
+            int* nodeValues = &chunkValues[id * lanes];
+            for (int j = 0; j < lanes; j++) {
+                depTotals[j] = getDependencyTotal(id, chunkValues, lanes, j);
+            }
+            column = scenarios.columns.find(string(nodes->getName(id)));
+            const int* columnValues = column == scenarios.columns.end()
+                ? NULL : column->second.data() + start;
+            nodes->getValues(id, columnValues, depTotals.data(), nodeValues, lanes);
+            for (int j = 0; j < lanes; j++) {
+                totals[start + j] += nodeValues[j];
+            }
+        }
+    }
+    int duration = getGraphDuration();
+    results.resize(count);
+    for (int j = 0; j < count; j++) {
+        results[j].value = totals[j];
+        results[j].duration = duration;
+    }
+    return true;
+}
+
+// every node carries columns.count values instead of one: its column of
+// the file, or its own value in every element. expressions apply to each
+// element and the value of a node is the sum of its elements.
+bool Scheduler::setVectors(const Scenarios &columns) {
+    map<string, vector<int> >::const_iterator column;
+    size_t found = 0;
+    vectorColumns.assign(nodes->size(), vector<int>());
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        column = columns.columns.find(string(nodes->getName(i)));
+        if (column != columns.columns.end()) {
+            vectorColumns[i] = column->second;
+            found++;
+        }
+    }
+    if (found != columns.columns.size()) {
+        cerr << "The vectors name nodes that are not in the graph.\n";
+        return false;
+    }
+    vectorLength = columns.count;
+    // neighbouring rows are written by different workers, so each fills
+    // whole cache lines
+    vectorStride = (vectorLength + 15) / 16 * 16;
+    vectorValues.assign((size_t) nodes->size() * vectorStride, 0);
+    return true;
+}
+
+// zero duration nodes with a constant value whose dependencies are all
+// precomputed too complete at time zero under any schedule, so they need
+// neither a worker nor an evaluation
+void Scheduler::findPrecomputed() {
+    precomputed.assign(nodes->size(), false);
+    for (size_t i = 0, max = topologicalOrder.size(); i < max; i++) {
+        NodeId id = topologicalOrder[i];
+        if (nodes->getDuration(id) != 0 || !nodes->isConstant(id)) {
+            continue;
+        }
+        bool ready = true;
+        for (NodeId dep : nodes->getDependencies(id)) {
+            ready = ready && precomputed[dep];
+        }
+        precomputed[id] = ready;
+    }
+}
+
+// finish the precomputed nodes on this thread, printing them first. their
+// other successors are signalled as usual, those made ready are returned to
+// be submitted with the roots.
+vector<NodeId> Scheduler::completePrecomputed() {
+    vector<NodeId> ready;
+    for (size_t i = 0, max = topologicalOrder.size(); i < max; i++) {
+        NodeId id = topologicalOrder[i];
+        if (!precomputed[id]) {
+            continue;
+        }
+        values[id] = vectorLength ? computeVector(id) : nodes->getValue(id, 0);
+        // every process precomputes the same nodes, each counts its own
+        if (isLocal(id)) {
+            incrementTotal(values[id]);
+            printComputation(id, values[id], 0);
+        }
+        for (NodeId next : nodes->getNextNodes(id)) {
+            if (!precomputed[next] && isLocal(next)
+                    && countdowns.signal(next, isPrivate(next))) {
+                ready.push_back(next);
+            }
+        }
+        finishNode();
+    }
+    return ready;
+}
+
+// a node of another process completes here when its value arrives, unless
+// no node of this process depends on it
+void Scheduler::finishRemoteNodes() {
+    for (int i = 0, max = partitions.size(); i < max; i++) {
+        if (isLocal(i) || precomputed[i]) {
+            continue;
+        }
+        bool waited = false;
+        for (NodeId next : nodes->getNextNodes(i)) {
+            waited = waited || isLocal(next);
+        }
+        if (!waited) {
+            finishNode();
+        }
+    }
+}
+
+// a pinned pool runs every node on the worker it is placed on, keeping
+// chains and diamonds on one worker and spilling them to workers on the
+// same NUMA node. only the counts of nodes whose dependencies run on
+// several threads need to be synchronized.
+void Scheduler::placeNodes() {
+    placement.clear();
+    privateCounts.clear();
+    if (pool->getBackend() != POOL_PINNED) {
+        return;
+    }
+    placement = partitionGraph(*nodes, topologicalOrder, pool->getWorkerGroups());
+    privateCounts.assign(nodes->size(), false);
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        int worker = -1;
+        bool single = true;
+        for (NodeId dep : nodes->getDependencies(i)) {
+            // precomputed and remote nodes are signalled off the pool
+            single = single && !precomputed[dep] && isLocal(dep)
+                && (worker == -1 || placement[dep] == worker);
+            worker = placement[dep];
+        }
+        privateCounts[i] = single && worker != -1;
+    }
+}
+
+bool Scheduler::isPrivate(NodeId id) {
+    return !privateCounts.empty() && privateCounts[id];
+}
+
+// a node whose only successor depends on nothing else runs that successor
+// right after it on the same worker, so a linear chain is one task that
+// needs neither a countdown nor a queue for each hop. on a pinned pool
+// both must be placed on the same worker, whose counts they may share.
+void Scheduler::fuseChains() {
+    fusedNext.clear();
+    if (!fusion) {
+        return;
+    }
+    fusedNext.assign(nodes->size(), -1);
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        Span<NodeId> next = nodes->getNextNodes(i);
+        if (precomputed[i] || !isLocal(i) || next.size() != 1
+                || nodes->getDepCount(next[0]) != 1 || !isLocal(next[0])
+                || (!placement.empty() && placement[next[0]] != placement[i])) {
+            continue;
+        }
+        fusedNext[i] = next[0];
+    }
+}
+
+// the roots and the nodes the precomputed ones made ready are submitted at
+// once, so that the policy picks among all of them instead of the first
+// worker taking the first node
+void Scheduler::submitRoots(vector<NodeId> ready) {
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        if (nodes->getDepCount(i) == 0 && !precomputed[i] && isLocal(i)) {
+            ready.push_back(i);
+        }
+    }
+    vector<Noduler> roots;
+    vector<int> workers;
+    for (NodeId id : ready) {
+        TRACE_EVENT(TRACE_READY, id);
+        roots.push_back(Noduler(this, id, bottomLevels[id]));
+        if (!placement.empty()) {
+            workers.push_back(placement[id]);
+        }
+    }
+    pool->submit(roots, workers);
+}
+
+void Scheduler::submitNode(NodeId id) {
+    TRACE_EVENT(TRACE_READY, id);
+    // package this scheduler object and the ready node into one struct
+    if (placement.empty()) {
+        pool->submit(Noduler(this, id, bottomLevels[id]));
+    } else {
+        pool->submit(Noduler(this, id, bottomLevels[id]), placement[id]);
+    }
+}
+
+void* Scheduler::_runNode(void* context) {
+    Noduler* noduler = (Noduler*) context;
+    noduler->scheduler->countdowns.run(noduler->node);
+    return NULL;
+}
+
+// a node that waited off the pool is ready to run on it again
+void Scheduler::wakeNode(NodeId id) {
+    submitNode(id);
+}
+
+// run the node and the rest of the chain fused after it, each sleeping out
+// its duration on this worker
+void Scheduler::runChain(NodeId id) {
+    while (id != -1) {
+        TRACE_EVENT(TRACE_WAKE, id);
+        // even sleep(0) waits out the timer slack, tens of microseconds
+        if (nodes->getDuration(id) > 0) {
+            sleep(nodes->getDuration(id));
+        }
+        id = completeNode(id);
+    }
+}
+
+// compute a node whose duration has passed and signal its successors.
+// returns the member of its chain to run next or -1
+NodeId Scheduler::completeNode(NodeId id) {
+    // compute value
+    int value = computeValue(id);
+    // increment computed value in shared global variable.
+    incrementTotal(value);
+    // keep the value for the nodes that depend on this one, they read it
+    // only after the signal below makes them ready
+    values[id] = value;
+    // print info
+    printComputation(id, value, finishTime());
+    // the next member of a chain is the only successor and runs next on
+    // this worker, any other successors are signalled
+    NodeId next = fusedNext.empty() ? -1 : fusedNext[id];
+    if (next == -1) {
+        signalNextNodes(id);
+        if (link) {
+            link->send(id, value);
+        }
+    }
+    TRACE_EVENT(TRACE_SIGNAL_END, id);
+    finishNode();
+    return next;
+}
+
+void Scheduler::finishNode() {
+    countdowns.finish();
+}
+
+void Scheduler::printComputation(NodeId id, int value, int duration) {
+    if (output) {
+        output->push(id, value, duration);
+    }
+}
+
+int Scheduler::computeValue(NodeId id) {
+    TRACE_EVENT(TRACE_COMPUTE_BEGIN, id);
+    int value = vectorLength ? computeVector(id) : nodes->getValue(id, getDependencyTotal(id));
+    TRACE_EVENT(TRACE_COMPUTE_END, id);
+    return value;
+}
+
+// the elements of a vector node, V being the element by element sum of
+// the vectors of its dependencies, which is reduced to the value it returns
+int Scheduler::computeVector(NodeId id) {
+    int* row = &vectorValues[(size_t) id * vectorStride];
+    if (!nodes->getExpression(id).empty()) {
+        fill(row, row + vectorLength, 0);
+        for (NodeId dep : nodes->getDependencies(id)) {
+            addValues(row, &vectorValues[(size_t) dep * vectorStride], vectorLength);
+        }
+    }
+    const vector<int> &column = vectorColumns[id];
+    nodes->getValues(id, column.empty() ? NULL : column.data(), row, row, vectorLength);
+    return sumValues(row, vectorLength);
+}
+
+// each worker adds to its own slot, the slots are summed once the workers
+// have been joined
+void Scheduler::incrementTotal(int value) {
+    partialTotals[currentWorkerIndex() + 1].sum += value;
+}
+
+// the whole seconds since the run started, the time the node completed on
+// the workers of this run rather than on unlimited ones
+int Scheduler::finishTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long elapsed = (now.tv_sec - startTime.tv_sec) * 1000000000L + now.tv_nsec - startTime.tv_nsec;
+    int time = (elapsed + 500000000L) / 1000000000L;
+    PartialTotal &slot = partialTotals[currentWorkerIndex() + 1];
+    slot.latest = std::max(slot.latest, time);
+    return time;
+}
+
+// the makespan of the run, the latest time any node completed
+int Scheduler::reduceFinishTimes() {
+    int latest = 0;
+    for (size_t i = 0, max = partialTotals.size(); i < max; i++) {
+        latest = std::max(latest, partialTotals[i].latest);
+    }
+    return latest;
+}
+
+int Scheduler::reduceTotals() {
+    int total = 0;
+    for (size_t i = 0, max = partialTotals.size(); i < max; i++) {
+        total += partialTotals[i].sum;
+    }
+    return total;
+}
+
+// the V of a node, the sum of the values of the nodes it depends on
+int Scheduler::getDependencyTotal(NodeId id) {
+    int total = 0;
+    for (NodeId dep : nodes->getDependencies(id)) {
+        total += values[dep];
+    }
+    return total;
+}
+
+// the same for scenario lane of a chunk holding lanes values per node
+int Scheduler::getDependencyTotal(NodeId id, const vector<int> &values, int lanes, int lane) {
+    int total = 0;
+    for (NodeId dep : nodes->getDependencies(id)) {
+        total += values[dep * lanes + lane];
+    }
+    return total;
+}
+
+void Scheduler::signalNextNodes(NodeId id) {
+    for (NodeId next : nodes->getNextNodes(id)) {
+        if (isLocal(next)) {
+            signalNode(next);
+        }
+    }
+}
+
+// the value of a node of another process arrived, its successors here may
+// be ready now
+void Scheduler::completeRemote(NodeId id, int value) {
+    values[id] = value;
+    signalNextNodes(id);
+    finishNode();
+}
+
+void Scheduler::signalNode(NodeId id) {
+    // the last predecessor to finish makes the node ready
+    if (countdowns.signal(id, isPrivate(id))) {
+        submitNode(id);
+    }
+}
+
+int Scheduler::getGraphDuration() {
+    int maxDur = 0;
+    int duration;
+    for (int i = 0, max = nodes->size(); i < max; i++) {
+        duration = nodes->getTotalDuration(i);
+        if (duration > maxDur) {
+            maxDur = duration;
+        }
+    }
+    return maxDur;
+}
+
+string durationSeconds(int duration) {
+    stringstream ss;
+    ss << duration << " second" << ((duration == 1) ? "" : "s");
+    return ss.str();
+}
@@ -0,0 +1,135 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "node.hpp"
+#include "pool.hpp"
+#include "output.hpp"
+#include "countdown.hpp"
+#include <map>
+#include <string>
+#include <vector>
+#include <time.h>
+
+typedef struct {
+    int value;
+    int duration;
+} GraphResult;
+
+// the values of nodes without an expression in each scenario, nodes that
+// are missing keep their configured value in all of them
+struct Scenarios {
+    int count;
+    std::map<std::string, std::vector<int> > columns;
+};
+
+// the values one worker has added to the total and the latest time a node
+// it ran completed, alone on its cache line so that workers never write to
+// the same line
+struct alignas(64) PartialTotal {
+    int sum;
+    int latest;
+    PartialTotal() : sum(0), latest(0) {}
+};
+
+class PartitionLink;
+
+// runs the nodes of a graph on a pool. what differs between the binaries,
+// how a node counts down its dependencies, waits out its duration and is
+// woken, is left to their Countdowns
+class Scheduler {
+    public:
+        Scheduler(NodeStore*, int, PoolBackend);
+        Scheduler(NodeStore*, std::vector<NodeId>, int, PoolBackend);
+        ~Scheduler();
+        bool isAcyclic();
+        void setPolicy(QueuePolicy);
+        void setFusion(bool);
+        void setOutputFormat(OutputFormat);
+        void setOutput(ResultWriter*);
+        void setPartition(const std::vector<int> &partitions, int, PartitionLink*);
+        void printResult(GraphResult);
+        void printRemote(NodeId, int value, int time);
+        int getLowerBound();
+        NodeStore &getNodes();
+        NodeStore* releaseNodes();
+        const std::vector<NodeId> &getTopologicalOrder();
+        GraphResult run();
+        void start(WorkerPool*);
+        GraphResult wait();
+        GraphResult simulate();
+        void setNodeValue(NodeId, int);
+        void setNodeExpression(NodeId, Span<Instruction>);
+        GraphResult recompute();
+        void completeRemote(NodeId, int value);
+        bool runScenarios(const Scenarios &scenarios, std::vector<GraphResult> &results);
+        bool setVectors(const Scenarios &columns);
+        void wakeNode(NodeId);
+        static void* _runNode(void*);
+    private:
+        NodeStore* nodes;
+        std::vector<NodeId> topologicalOrder; // shorter than nodes for a cycle
+        int threadCount;
+        PoolBackend backend;
+        QueuePolicy policy;
+        std::vector<int> bottomLevels; // longest path from each node to a sink
+        WorkerPool* pool;
+        OutputFormat outputFormat;
+        ResultWriter* output; // opened when the first result is printed
+        bool ownsOutput;
+        std::vector<int> values; // the value each node computed
+        std::vector<PartialTotal> partialTotals; // slot 0 is off the pool
+        struct timespec startTime; // when the run started
+        std::vector<bool> precomputed; // finished before the workers start
+        std::vector<NodeId> editedNodes; // edited since the last computation
+        std::vector<int> topologicalPositions; // index of each node in the order
+        std::vector<int> partitions; // process running each node, empty if all run here
+        int partition; // the process this scheduler runs in
+        PartitionLink* link; // sends completed nodes to the other processes
+        std::vector<int> placement; // worker of a pinned pool running each node
+        // every dependency of the node runs on one worker, which alone
+        // counts them down
+        std::vector<bool> privateCounts;
+        bool fusion; // run linear chains as one task
+        std::vector<NodeId> fusedNext; // the chain member run after each node or -1
+        int vectorLength; // values every node carries, 0 when each has one
+        int vectorStride; // the length padded to whole cache lines
+        std::vector<int> vectorValues; // vectorStride values for each node
+        std::vector<std::vector<int> > vectorColumns; // empty to broadcast the value
+        Countdowns countdowns;
+
+        void initScheduler(int, PoolBackend);
+        void sortNodes();
+        void computeTotalDurations();
+        void computeBottomLevels();
+        void openOutput();
+        bool isLocal(NodeId);
+        void finishRemoteNodes();
+        void placeNodes();
+        bool isPrivate(NodeId);
+        void fuseChains();
+        void findPrecomputed();
+        std::vector<NodeId> completePrecomputed();
+        void submitRoots(std::vector<NodeId>);
+        void submitNode(NodeId);
+        void runChain(NodeId);
+        NodeId completeNode(NodeId);
+        void finishNode();
+        int computeValue(NodeId);
+        int computeVector(NodeId);
+        void incrementTotal(int);
+        int reduceTotals();
+        int finishTime();
+        int reduceFinishTimes();
+        int getDependencyTotal(NodeId);
+        int getDependencyTotal(NodeId, const std::vector<int> &values, int, int);
+        void signalNextNodes(NodeId);
+        void signalNode(NodeId);
+        int getGraphDuration();
+        void printComputation(NodeId, int, int);
+
+        friend class Countdowns;
+};
+
+std::string durationSeconds(int);
+
+#endif
@@ -0,0 +1,186 @@
+// Dylan Richardson
+#include "serve.hpp"
+#include "scheduler.hpp"
+#include "node.hpp"
+#include "pool.hpp"
+#include "parser.hpp"
+#include "gbin.hpp"
+#include "optimize.hpp"
+#include "output.hpp"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+// what every connection of the server shares
+struct Server {
+    WorkerPool* pool; // started once, every request runs on it
+    int threads;
+    PoolBackend backend;
+    QueuePolicy policy;
+    OutputFormat format;
+    bool optimize;
+};
+
+struct Connection {
+    Server* server;
+    int fd;
+};
+
+// set up a scheduler for the graph of a request, laid out in the store of
+// its connection. the store is left to the connection either way.
+Scheduler* parseRequest(const Server &server, const vector<char> &request, NodeStore* nodes) {
+    Scheduler* scheduler;
+    if (isGbin(request.data(), request.size())) {
+        scheduler = readGbin(request.data(), request.size(), nodes, server.threads,
+                             server.backend);
+        if (!scheduler) {
+            return NULL;
+        }
+    } else {
+        ConfigParser parser("request", string_view(request.data(), request.size()));
+        if (!parser.parse(*nodes)) {
+            return NULL;
+        }
+        scheduler = new Scheduler(nodes, server.threads, server.backend);
+    }
+    // a compiled graph is sorted again when its order can not be trusted
+    if (!scheduler->isAcyclic()) {
+        cerr << "The dependencies of the request form a cycle.\n";
+        scheduler->releaseNodes();
+        delete scheduler;
+        return NULL;
+    }
+    return scheduler;
+}
+
+// run the graph of a request and write its output as frames, the reply
+// follows once the last frame is out
+ServeReply runRequest(const Server &server, const vector<char> &request, NodeStore* nodes,
+                      ResultWriter* output) {
+    ServeReply reply = { SERVE_INVALID, 0, 0 };
+    nodes->reset();
+    Scheduler* scheduler = parseRequest(server, request, nodes);
+    if (!scheduler) {
+        return reply;
+    }
+    if (server.optimize) {
+        optimizeExpressions(*nodes);
+    }
+    scheduler->setPolicy(server.policy);
+    scheduler->setOutputFormat(server.format);
+    if (output) {
+        scheduler->setOutput(output);
+    }
+    scheduler->start(server.pool);
+    GraphResult result = scheduler->wait();
+    scheduler->printResult(result);
+    scheduler->releaseNodes();
+    delete scheduler;
+    reply.status = SERVE_OK;
+    reply.value = result.value;
+    reply.duration = result.duration;
+    return reply;
+}
+
+// answer the requests of one client until it hangs up. the store and the
+// writer live as long as the connection, so a request only grows the
+// arena when its graph is larger than every one before it.
+void serveConnection(Server &server, int fd) {
+    NodeStore* nodes = new NodeStore();
+    ResultWriter* output = NULL;
+    if (server.format != OUTPUT_NONE) {
+        output = new ResultWriter(*nodes, server.format, fd, true);
+    }
+    vector<char> request;
+    int32_t length;
+    while (readFully(fd, &length, sizeof(length))) {
+        if (length < 1 || length > SERVE_MAX_REQUEST) {
+            cerr << "A request of " << length << " bytes was refused.\n";
+            break;
+        }
+        request.resize(length);
+        if (!readFully(fd, request.data(), length)) {
+            break;
+        }
+        ServeReply reply = runRequest(server, request, nodes, output);
+        int32_t end = 0;
+        if (!writeFully(fd, &end, sizeof(end)) || !writeFully(fd, &reply, sizeof(reply))) {
+            break;
+        }
+    }
+    // the writer formats node names until it is deleted
+    delete output;
+    delete nodes;
+    close(fd);
+}
+
+void* _serveConnection(void* context) {
+    Connection* connection = (Connection*) context;
+    serveConnection(*connection->server, connection->fd);
+    delete connection;
+    return NULL;
+}
+
+// listen on a Unix domain socket and run the graphs sent to it on one warm
+// worker pool, every connection on its own thread. only returns if the
+// socket fails.
+bool runServer(string path, int threads, PoolBackend backend, QueuePolicy policy,
+               OutputFormat format, bool optimize) {
+    struct sockaddr_un address;
+    if (path.size() >= sizeof(address.sun_path)) {
+        cerr << "The socket path is too long: " << path << "\n";
+        return false;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path.c_str());
+    // a client that hangs up fails the write instead of ending the server
+    signal(SIGPIPE, SIG_IGN);
+    unlink(path.c_str());
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == -1 || bind(listener, (struct sockaddr*) &address, sizeof(address))
+            || listen(listener, SOMAXCONN)) {
+        cerr << "Could not listen on the socket: " << path << "\n";
+        if (listener != -1) {
+            close(listener);
+        }
+        return false;
+    }
+    WorkerPool pool(threads, backend, policy);
+    Server server = { &pool, threads, backend, policy, format, optimize };
+    cout << "Serving on " << path << " with " << threads << " threads.\n" << flush;
+    while (true) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd == -1 && (errno == EINTR || errno == ECONNABORTED)) {
+            continue;
+        }
+        if (fd == -1) {
+            cerr << "Could not accept a connection on the socket: " << path << "\n";
+            break;
+        }
+        Connection* connection = new Connection();
+        connection->server = &server;
+        connection->fd = fd;
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, _serveConnection, (void*) connection)) {
+            cerr << "Failed to create a connection thread.\n";
+            close(fd);
+            delete connection;
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    close(listener);
+    return false;
+}
@@ -0,0 +1,29 @@
+#ifndef SERVE_H
+#define SERVE_H
+
+#include "output.hpp"
+#include "pool.hpp"
+#include <stdint.h>
+#include <string>
+
+// a request is the int32 length of a config or a compiled graph followed by
+// its bytes. the reply is the output of the run as frames of an int32
+// length followed by that many bytes, then an int32 0 and a ServeReply.
+// requests on one connection are answered in order.
+
+const int32_t SERVE_MAX_REQUEST = 1 << 30;
+
+enum ServeStatus {
+    SERVE_OK,      // the graph ran, the reply holds its total
+    SERVE_INVALID  // the graph could not be parsed or has a cycle
+};
+
+struct ServeReply {
+    int32_t status;
+    int32_t value;
+    int32_t duration;
+};
+
+bool runServer(std::string path, int threads, PoolBackend, QueuePolicy, OutputFormat, bool optimize);
+
+#endif
@@ -0,0 +1,98 @@
+// Dylan Richardson
+#include "topology.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <ctype.h>
+#include <sched.h>
+#include <stdlib.h>
+
+using namespace std;
+
+const string NODE_DIRECTORY = "/sys/devices/system/node/node";
+
+// the cpus of every NUMA node the kernel lists, without those outside the
+// affinity of the process. a kernel without NUMA puts every cpu the
+// process may use on one node.
+CpuTopology readTopology() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool masked = !sched_getaffinity(0, sizeof(allowed), &allowed);
+    CpuTopology topology;
+    vector<int> cpus;
+    // node ids may have gaps, a few missing ones in a row end the search
+    for (int node = 0, missing = 0; missing < 8; node++) {
+        ifstream file((NODE_DIRECTORY + to_string(node) + "/cpulist").c_str());
+        string list;
+        if (!file || !getline(file, list) || !parseCpuList(list, cpus)) {
+            missing++;
+            continue;
+        }
+        missing = 0;
+        vector<int> usable;
+        for (int cpu : cpus) {
+            if (!masked || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) {
+                usable.push_back(cpu);
+            }
+        }
+        if (!usable.empty()) {
+            topology.nodeCpus.push_back(usable);
+        }
+    }
+    if (topology.nodeCpus.empty()) {
+        vector<int> usable;
+        for (int cpu = 0; masked && cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                usable.push_back(cpu);
+            }
+        }
+        if (usable.empty()) {
+            usable.push_back(0);
+        }
+        topology.nodeCpus.push_back(usable);
+    }
+    return topology;
+}
+
+// pin the workers one NUMA node at a time so that neighbouring workers share
+// a node, taking as many from each node as it has cpus. with more workers
+// than cpus the placement starts over from the first node.
+void placeWorkers(const CpuTopology &topology, int threads, vector<int> &cpus,
+                  vector<int> &groups) {
+    cpus.clear();
+    groups.clear();
+    while ((int) cpus.size() < threads) {
+        for (size_t node = 0, max = topology.nodeCpus.size(); node < max; node++) {
+            for (int cpu : topology.nodeCpus[node]) {
+                if ((int) cpus.size() < threads) {
+                    cpus.push_back(cpu);
+                    groups.push_back(node);
+                }
+            }
+        }
+    }
+}
+
+// a kernel cpu list such as "0-3,8,10-11"
+bool parseCpuList(string list, vector<int> &cpus) {
+    cpus.clear();
+    size_t start = 0;
+    while (start < list.size() && !isspace(list[start])) {
+        size_t end = list.find(',', start);
+        if (end == string::npos) {
+            end = list.size();
+        }
+        string range = list.substr(start, end - start);
+        size_t dash = range.find('-');
+        if (range.empty() || !isdigit(range[0])) {
+            return false;
+        }
+        int first = atoi(range.c_str());
+        int last = dash == string::npos ? first : atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+        start = end + 1;
+    }
+    return !cpus.empty();
+}
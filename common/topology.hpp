@@ -0,0 +1,17 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+// the cpus this process may run on, grouped by the NUMA node they belong to
+struct CpuTopology {
+    std::vector<std::vector<int> > nodeCpus;
+};
+
+CpuTopology readTopology();
+void placeWorkers(const CpuTopology &topology, int threads, std::vector<int> &cpus,
+                  std::vector<int> &groups);
+bool parseCpuList(std::string, std::vector<int> &cpus);
+
+#endif
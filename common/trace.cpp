@@ -0,0 +1,111 @@
+// Dylan Richardson
+#include "trace.hpp"
+#include "node.hpp"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+
+using namespace std;
+
+struct TraceBuffer {
+    int thread;
+    vector<TraceEvent> events;
+};
+
+// the buffer of every thread that has recorded an event, kept after the
+// thread exits so that it can be written out
+static vector<TraceBuffer*> TRACE_BUFFERS;
+static sem_t TRACE_MUTEX;
+static __thread TraceBuffer* CURRENT_BUFFER = NULL;
+static pthread_once_t TRACE_ONCE = PTHREAD_ONCE_INIT;
+
+void initTraceMutex() {
+    sem_init(&TRACE_MUTEX, 0, 1);
+}
+
+// only the first event of each thread takes the lock
+TraceBuffer* registerTraceBuffer() {
+    pthread_once(&TRACE_ONCE, initTraceMutex);
+    TraceBuffer* buffer = new TraceBuffer;
+    buffer->events.reserve(1024);
+    sem_wait(&TRACE_MUTEX);
+    buffer->thread = TRACE_BUFFERS.size();
+    TRACE_BUFFERS.push_back(buffer);
+    sem_post(&TRACE_MUTEX);
+    return buffer;
+}
+
+void traceEvent(TraceKind kind, NodeId node) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    if (!CURRENT_BUFFER) {
+        CURRENT_BUFFER = registerTraceBuffer();
+    }
+    TraceEvent event;
+    event.time = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    event.node = node;
+    event.kind = kind;
+    CURRENT_BUFFER->events.push_back(event);
+}
+
+// write one Chrome trace_event record. the wait between a node becoming
+// ready and a worker waking for it crosses threads, so it is an async span
+// keyed by the node id
+void writeTraceEvent(ofstream &file, const TraceEvent &event, int thread,
+                     long long start, string_view name, bool &first) {
+    const char* phases[] = { "b", "e", "B", "E", "E" };
+    file << (first ? "\n" : ",\n");
+    first = false;
+    file << "{\"name\": \"" << (event.kind < TRACE_COMPUTE_BEGIN ? "wait " : "") << name
+         << "\", \"cat\": \"" << (event.kind < TRACE_COMPUTE_BEGIN ? "schedule" : "node")
+         << "\", \"ph\": \"" << phases[event.kind] << "\"";
+    if (event.kind < TRACE_COMPUTE_BEGIN) {
+        file << ", \"id\": " << event.node;
+    }
+    file << ", \"ts\": " << (event.time - start) / 1000.0
+         << ", \"pid\": 1, \"tid\": " << thread << "}";
+    // signalling the successors is its own span after the computation
+    if (event.kind == TRACE_COMPUTE_END) {
+        file << ",\n{\"name\": \"signal " << name << "\", \"cat\": \"node\", \"ph\": \"B\", \"ts\": "
+             << (event.time - start) / 1000.0 << ", \"pid\": 1, \"tid\": " << thread << "}";
+    }
+}
+
+bool traceCompiledIn() {
+#ifdef TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool writeTrace(string fileName, const NodeStore &nodes) {
+    long long start = -1;
+    for (size_t i = 0, max = TRACE_BUFFERS.size(); i < max; i++) {
+        if (!TRACE_BUFFERS[i]->events.empty()
+                && (start < 0 || TRACE_BUFFERS[i]->events[0].time < start)) {
+            start = TRACE_BUFFERS[i]->events[0].time;
+        }
+    }
+    ofstream file(fileName.c_str());
+    file << "{\"traceEvents\": [";
+    bool first = true;
+    for (size_t i = 0, max = TRACE_BUFFERS.size(); i < max; i++) {
+        const vector<TraceEvent> &events = TRACE_BUFFERS[i]->events;
+        for (size_t j = 0, maxj = events.size(); j < maxj; j++) {
+            writeTraceEvent(file, events[j], TRACE_BUFFERS[i]->thread, start,
+                            nodes.getName(events[j].node), first);
+        }
+    }
+    file << "\n], \"displayTimeUnit\": \"ms\"}\n";
+    if (!file) {
+        cerr << "Could not write the trace: " << fileName << "\n";
+        return false;
+    }
+    return true;
+}
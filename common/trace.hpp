@@ -0,0 +1,36 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "node.hpp"
+#include <string>
+#include <vector>
+
+// the points in the life of a node that the tracer records
+enum TraceKind {
+    TRACE_READY,         // the last dependency finished and the node was queued
+    TRACE_WAKE,          // a worker took the node off a queue
+    TRACE_COMPUTE_BEGIN,
+    TRACE_COMPUTE_END,
+    TRACE_SIGNAL_END     // every successor has been signalled
+};
+
+struct TraceEvent {
+    long long time; // nanoseconds on the monotonic clock
+    NodeId node;
+    TraceKind kind;
+};
+
+// events are appended to a buffer owned by the recording thread, so
+// recording takes no locks. building without -DTRACE removes every
+// TRACE_EVENT from the scheduler.
+#ifdef TRACE
+#define TRACE_EVENT(kind, node) traceEvent(kind, node)
+#else
+#define TRACE_EVENT(kind, node) ((void) 0)
+#endif
+
+void traceEvent(TraceKind, NodeId);
+bool traceCompiledIn();
+bool writeTrace(std::string, const NodeStore &nodes);
+
+#endif
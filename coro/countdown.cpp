@@ -0,0 +1,104 @@
+// Dylan Richardson
+#include "countdown.hpp"
+#include "scheduler.hpp"
+#include "nblock.hpp"
+#include "timer.hpp"
+#include "trace.hpp"
+#include <coroutine>
+#include <vector>
+#include <semaphore.h>
+
+using namespace std;
+
+Countdowns::Countdowns() {
+    scheduler = NULL;
+    doneBlock = -1;
+    sem_init(&finished, 0, 0);
+    timer = NULL;
+}
+
+Countdowns::~Countdowns() {
+    for (size_t i = 0, max = nBlockIds.size(); i < max; i++) {
+        nBlocks.DestroyNBlock(nBlockIds[i]);
+    }
+    if (doneBlock != -1) {
+        nBlocks.DestroyNBlock(doneBlock);
+    }
+    sem_destroy(&finished);
+}
+
+void Countdowns::init(Scheduler* scheduler, const NodeStore &nodes) {
+    this->scheduler = scheduler;
+    nBlockIds.resize(nodes.size());
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        nBlockIds[i] = nBlocks.CreateNBlock(nodes.getDepCount(i));
+    }
+    doneBlock = nBlocks.CreateNBlock(nodes.size());
+}
+
+// returns true for the signal that released the nblock of the node
+bool Countdowns::signal(NodeId id, bool isPrivate) {
+    return isPrivate ? nBlocks.SignalLocalNBlock(nBlockIds[id])
+                     : nBlocks.SignalNBlock(nBlockIds[id]);
+}
+
+// every node run here starts as a coroutine suspended on its nblock, the
+// nodes fused after the head of a chain run inside the coroutine of the head
+void Countdowns::start() {
+    const NodeStore &nodes = scheduler->getNodes();
+    suspended.assign(nodes.size(), coroutine_handle<>());
+    vector<bool> fused(nodes.size(), false);
+    for (size_t i = 0, max = scheduler->fusedNext.size(); i < max; i++) {
+        if (scheduler->fusedNext[i] != -1) {
+            fused[scheduler->fusedNext[i]] = true;
+        }
+    }
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        if (!scheduler->precomputed[i] && scheduler->isLocal(i) && !fused[i]) {
+            runChain(i);
+        }
+    }
+    // the timer thread is only needed if some node has a duration
+    if (scheduler->getGraphDuration() > 0) {
+        timer = new Timer();
+    }
+}
+
+// run the node and the rest of the chain fused after it. between the
+// awaits the coroutine runs on whichever worker resumed it
+NodeTask Countdowns::runChain(NodeId id) {
+    co_await NBlockAwaiter{this, id};
+    while (id != -1) {
+        TRACE_EVENT(TRACE_WAKE, id);
+        int duration = scheduler->getNodes().getDuration(id);
+        if (duration > 0) {
+            co_await TimerAwaiter{this, id, duration};
+        }
+        id = scheduler->completeNode(id);
+    }
+}
+
+// resume the coroutine of the node where it was suspended
+void Countdowns::run(NodeId id) {
+    suspended[id].resume();
+}
+
+void Countdowns::finish() {
+    if (nBlocks.SignalNBlock(doneBlock)) {
+        sem_post(&finished);
+    }
+}
+
+void Countdowns::wait() {
+    sem_wait(&finished);
+    delete timer;
+    timer = NULL;
+}
+
+// the node may be resumed as soon as the timer has it, so nothing of the
+// awaiter, which lives in the coroutine frame, is touched after that
+void TimerAwaiter::await_suspend(coroutine_handle<> handle) {
+    Countdowns* countdowns = this->countdowns;
+    countdowns->suspended[node] = handle;
+    countdowns->timer->add(seconds, Noduler(countdowns->scheduler, node));
+}
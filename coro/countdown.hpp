@@ -0,0 +1,77 @@
+#ifndef COUNTDOWN_H
+#define COUNTDOWN_H
+
+#include "node.hpp"
+#include "nblock.hpp"
+#include "timer.hpp"
+#include <coroutine>
+#include <exception>
+#include <vector>
+#include <semaphore.h>
+
+class Scheduler;
+
+// the coroutine running a node. it starts when it is created and frees its
+// frame when it returns, nothing ever holds on to it
+struct NodeTask {
+    struct promise_type {
+        NodeTask get_return_object() { return NodeTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// every node runs as a coroutine that co_awaits the nblock counting down its
+// dependencies and then the timer for its duration, so that a waiting node
+// holds no worker. the nodes of a run are one more nblock that is released
+// once all of them completed.
+class Countdowns {
+    public:
+        Countdowns();
+        ~Countdowns();
+        void init(Scheduler*, const NodeStore &nodes);
+        bool signal(NodeId, bool isPrivate);
+        void start();
+        void run(NodeId);
+        void finish();
+        void wait();
+    private:
+        Scheduler* scheduler;
+        NBlockTable nBlocks;
+        std::vector<int> nBlockIds; // indexed by node index
+        int doneBlock; // released once every node has completed
+        sem_t finished; // posted by the signal that releases doneBlock
+        std::vector<std::coroutine_handle<> > suspended; // where each node waits
+        Timer* timer; // runs while nodes of the run have a duration
+
+        NodeTask runChain(NodeId);
+
+        friend struct NBlockAwaiter;
+        friend struct TimerAwaiter;
+};
+
+// co_await on the nblock of a node suspends its coroutine until the
+// countdown reaches zero. the signal that releases it submits the node and
+// the worker that takes it resumes the coroutine.
+struct NBlockAwaiter {
+    Countdowns* countdowns;
+    NodeId node;
+    bool await_ready() { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { countdowns->suspended[node] = handle; }
+    void await_resume() {}
+};
+
+// co_await on the timer suspends the coroutine for the duration of the node
+// and resumes it on a worker afterwards, the worker runs other nodes meanwhile
+struct TimerAwaiter {
+    Countdowns* countdowns;
+    NodeId node;
+    int seconds;
+    bool await_ready() { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() {}
+};
+
+#endif
@@ -0,0 +1,102 @@
+// Dylan Richardson
+#include "timer.hpp"
+#include "scheduler.hpp"
+#include <iostream>
+#include <vector>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+
+using namespace std;
+
+bool Timer::Later::operator()(const Entry &a, const Entry &b) const {
+    if (a.deadline.tv_sec != b.deadline.tv_sec) {
+        return a.deadline.tv_sec > b.deadline.tv_sec;
+    }
+    if (a.deadline.tv_nsec != b.deadline.tv_nsec) {
+        return a.deadline.tv_nsec > b.deadline.tv_nsec;
+    }
+    return a.sequence > b.sequence;
+}
+
+static bool reached(const timespec &deadline, const timespec &now) {
+    return now.tv_sec > deadline.tv_sec
+        || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec);
+}
+
+Timer::Timer() {
+    added = 0;
+    stopping = false;
+    sem_init(&mutex, 0, 1);
+    sem_init(&wake, 0, 0);
+    if (pthread_create(&thread, NULL, _runTimer, (void*) this)) {
+        cerr << "Failed to create timer thread.\n";
+    }
+}
+
+// every node added must have woken, the thread exits once the queue is empty
+Timer::~Timer() {
+    sem_wait(&mutex);
+    stopping = true;
+    sem_post(&mutex);
+    sem_post(&wake);
+    if (pthread_join(thread, NULL)) {
+        cerr << "Failed to join timer thread.\n";
+    }
+    sem_destroy(&mutex);
+    sem_destroy(&wake);
+}
+
+// wake the node seconds from now. the deadlines are kept on the monotonic
+// clock, so setting the wall clock neither holds back nor hurries a node
+void Timer::add(int seconds, Noduler noduler) {
+    Entry entry;
+    clock_gettime(CLOCK_MONOTONIC, &entry.deadline);
+    entry.deadline.tv_sec += seconds;
+    entry.noduler = noduler;
+    sem_wait(&mutex);
+    entry.sequence = added++;
+    entries.push(entry);
+    sem_post(&mutex);
+    sem_post(&wake);
+}
+
+void* Timer::_runTimer(void* context) {
+    ((Timer*) context)->runTimer();
+    return NULL;
+}
+
+// the nodes are woken outside the lock, waking one may add another
+void Timer::runTimer() {
+    vector<Noduler> expired;
+    while (true) {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        sem_wait(&mutex);
+        while (!entries.empty() && reached(entries.top().deadline, now)) {
+            expired.push_back(entries.top().noduler);
+            entries.pop();
+        }
+        bool idle = entries.empty();
+        bool stop = idle && stopping && expired.empty();
+        timespec deadline = idle ? now : entries.top().deadline;
+        sem_post(&mutex);
+        if (stop) {
+            return;
+        }
+        for (size_t i = 0, max = expired.size(); i < max; i++) {
+            expired[i].scheduler->wakeNode(expired[i].node);
+        }
+        if (!expired.empty()) {
+            expired.clear();
+            continue;
+        }
+        // a post for a later node only costs one more pass
+        if (idle) {
+            sem_wait(&wake);
+        } else {
+            while (sem_clockwait(&wake, CLOCK_MONOTONIC, &deadline) && errno == EINTR) {}
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "pool.hpp"
+#include <queue>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+
+// wakes nodes once their duration has passed. a node waiting on the timer
+// holds no worker, one thread sleeps until the earliest deadline and hands
+// each expired node back to its scheduler.
+class Timer {
+    public:
+        Timer();
+        ~Timer();
+        void add(int seconds, Noduler);
+        static void* _runTimer(void*);
+    private:
+        struct Entry {
+            timespec deadline;
+            long sequence; // nodes with the same deadline wake in order
+            Noduler noduler;
+        };
+        struct Later {
+            bool operator()(const Entry &a, const Entry &b) const;
+        };
+        pthread_t thread;
+        std::priority_queue<Entry, std::vector<Entry>, Later> entries;
+        long added;
+        bool stopping;
+        sem_t mutex; // guards entries and stopping
+        sem_t wake; // posted when an earlier deadline or the stop arrives
+
+        void runTimer();
+};
+
+#endif
@@ -0,0 +1,68 @@
+// Dylan Richardson
+#include "countdown.hpp"
+#include "scheduler.hpp"
+#include <iostream>
+#include <vector>
+#include <semaphore.h>
+
+using namespace std;
+
+Countdowns::Countdowns() {
+    scheduler = NULL;
+    sem_init(&finished, 0, 0);
+}
+
+Countdowns::~Countdowns() {
+    for (size_t i = 0, max = semCtrls.size(); i < max; i++) {
+        sem_destroy(semCtrls[i]->semaphore);
+        delete semCtrls[i]->semaphore;
+        delete semCtrls[i];
+    }
+    sem_destroy(&finished);
+}
+
+void Countdowns::init(Scheduler* scheduler, const NodeStore &nodes) {
+    this->scheduler = scheduler;
+    semCtrls.resize(nodes.size());
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        SemCtrl* semCtrl = new SemCtrl;
+        semCtrl->count = nodes.getDepCount(i);
+        semCtrl->semaphore = new sem_t;
+        semCtrls[i] = semCtrl;
+        // the semaphore guards the count, which many predecessors decrement
+        if (sem_init(semCtrl->semaphore, 0, 1)) {
+            cerr << "Unable to initialize semaphore for node " << nodes.getName(i) << ".\n";
+        }
+    }
+}
+
+// returns true for the signal that took the count of the node to zero
+bool Countdowns::signal(NodeId id, bool isPrivate) {
+    // decrement the semaphore controller count and determine if equal to zero
+    SemCtrl* semCtrl = semCtrls[id];
+    if (isPrivate) {
+        return --semCtrl->count == 0;
+    }
+    sem_wait(semCtrl->semaphore);
+    bool ready = --semCtrl->count == 0;
+    sem_post(semCtrl->semaphore);
+    return ready;
+}
+
+void Countdowns::start() {}
+
+void Countdowns::run(NodeId id) {
+    scheduler->runChain(id);
+}
+
+void Countdowns::finish() {
+    sem_post(&finished);
+}
+
+// every node is finished once, whether it ran here, was precomputed or
+// completed in another process
+void Countdowns::wait() {
+    for (int i = 0, max = semCtrls.size(); i < max; i++) {
+        sem_wait(&finished);
+    }
+}
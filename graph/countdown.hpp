@@ -0,0 +1,34 @@
+#ifndef COUNTDOWN_H
+#define COUNTDOWN_H
+
+#include "node.hpp"
+#include <vector>
+#include <semaphore.h>
+
+class Scheduler;
+
+struct SemCtrl {
+    sem_t* semaphore;
+    int count;
+};
+
+// the dependencies each node still waits on, each count guarded by a
+// semaphore of its own, and a semaphore posted once for every node that
+// completes. a worker sleeps out the duration of the node it runs.
+class Countdowns {
+    public:
+        Countdowns();
+        ~Countdowns();
+        void init(Scheduler*, const NodeStore &nodes);
+        bool signal(NodeId, bool isPrivate);
+        void start();
+        void run(NodeId);
+        void finish();
+        void wait();
+    private:
+        Scheduler* scheduler;
+        std::vector<SemCtrl*> semCtrls; // indexed by node id
+        sem_t finished; // posted once for every node that completes
+};
+
+#endif
@@ -0,0 +1,55 @@
+// Dylan Richardson
+#include "countdown.hpp"
+#include "scheduler.hpp"
+#include "nblock.hpp"
+#include <vector>
+#include <semaphore.h>
+
+using namespace std;
+
+Countdowns::Countdowns() {
+    scheduler = NULL;
+    doneBlock = -1;
+    sem_init(&finished, 0, 0);
+}
+
+Countdowns::~Countdowns() {
+    for (size_t i = 0, max = nBlockIds.size(); i < max; i++) {
+        nBlocks.DestroyNBlock(nBlockIds[i]);
+    }
+    if (doneBlock != -1) {
+        nBlocks.DestroyNBlock(doneBlock);
+    }
+    sem_destroy(&finished);
+}
+
+void Countdowns::init(Scheduler* scheduler, const NodeStore &nodes) {
+    this->scheduler = scheduler;
+    nBlockIds.resize(nodes.size());
+    for (int i = 0, max = nodes.size(); i < max; i++) {
+        nBlockIds[i] = nBlocks.CreateNBlock(nodes.getDepCount(i));
+    }
+    doneBlock = nBlocks.CreateNBlock(nodes.size());
+}
+
+// returns true for the signal that released the nblock of the node
+bool Countdowns::signal(NodeId id, bool isPrivate) {
+    return isPrivate ? nBlocks.SignalLocalNBlock(nBlockIds[id])
+                     : nBlocks.SignalNBlock(nBlockIds[id]);
+}
+
+void Countdowns::start() {}
+
+void Countdowns::run(NodeId id) {
+    scheduler->runChain(id);
+}
+
+void Countdowns::finish() {
+    if (nBlocks.SignalNBlock(doneBlock)) {
+        sem_post(&finished);
+    }
+}
+
+void Countdowns::wait() {
+    sem_wait(&finished);
+}
@@ -0,0 +1,32 @@
+#ifndef COUNTDOWN_H
+#define COUNTDOWN_H
+
+#include "node.hpp"
+#include "nblock.hpp"
+#include <vector>
+#include <semaphore.h>
+
+class Scheduler;
+
+// the dependencies each node still waits on as the nblock of the node, and
+// the nodes of a run as one more nblock that is released once all of them
+// completed. a worker sleeps out the duration of the node it runs.
+class Countdowns {
+    public:
+        Countdowns();
+        ~Countdowns();
+        void init(Scheduler*, const NodeStore &nodes);
+        bool signal(NodeId, bool isPrivate);
+        void start();
+        void run(NodeId);
+        void finish();
+        void wait();
+    private:
+        Scheduler* scheduler;
+        NBlockTable nBlocks;
+        std::vector<int> nBlockIds; // indexed by node index
+        int doneBlock; // released once every node has completed
+        sem_t finished; // posted by the signal that releases doneBlock
+};
+
+#endif
@@ -1,45 +1,40 @@
 // Dylan Richardson
 #include "nblock.hpp"
-#include <semaphore.h>
-#include <map>
-#include <iostream>
+#include <atomic>
+#include <deque>
 
 using namespace std;
 
-map<int, NBlock*> NBID_NBLOCK;
-
-NBlock* getNBlock(int id) {
-    return NBID_NBLOCK[id];
+NBlockTable::NBlockTable() {
+    liveNBlocks = 0;
 }
 
-void setNBlock(NBlock* nBlock) {
-    NBID_NBLOCK[nBlock->id] = nBlock;
+NBlock* NBlockTable::getNBlock(int id) {
+    return &nBlocks[id];
 }
 
-int CreateNBlock(int n) {
-    NBlock* nBlock = new NBlock(n);
-    nBlock->semaphore = new sem_t;
-    if (sem_init(nBlock->semaphore, 0, n ? 0 : 1)) {
-        return -1;
-    }
-    setNBlock(nBlock);
-    return nBlock->id;
+int NBlockTable::CreateNBlock(int n) {
+    nBlocks.emplace_back(n);
+    liveNBlocks++;
+    return nBlocks.size() - 1;
 }
 
-void DestroyNBlock(int id) {
-    sem_destroy(getNBlock(id)->semaphore);
-    delete getNBlock(id)->semaphore;
-    delete getNBlock(id);
+void NBlockTable::DestroyNBlock(int) {
+    if (--liveNBlocks == 0) {
+        nBlocks.clear();
+    }
 }
 
-void WaitNBlock(int id) {
-    sem_wait(getNBlock(id)->semaphore);
+// returns true for the signal that released the nblock
+bool NBlockTable::SignalNBlock(int id) {
+    return getNBlock(id)->count.fetch_sub(1, memory_order_acq_rel) == 1;
 }
 
-void SignalNBlock(int id) {
+// the same for an nblock that only one thread ever signals, so the count
+// needs no atomic read-modify-write
+bool NBlockTable::SignalLocalNBlock(int id) {
     NBlock* nBlock = getNBlock(id);
-    nBlock->count--;
-    if (nBlock->count == 0) {
-        sem_post(nBlock->semaphore);
-    }
+    int count = nBlock->count.load(memory_order_relaxed) - 1;
+    nBlock->count.store(count, memory_order_relaxed);
+    return count == 0;
 }
@@ -1,19 +1,32 @@
 #ifndef NBLOCK_H
 #define NBLOCK_H
 
-#include <semaphore.h>
+#include <atomic>
+#include <deque>
 
-struct NBlock {
-    int id;
-    sem_t* semaphore;
-    int count;
-    static int currentId;
-    NBlock(int n) : id(currentId++), count(n) {}
+// a countdown of signals. the signal that releases an nblock is told so,
+// and whoever sent it carries on, nothing ever blocks on an nblock. each
+// nblock fills its own cache line so that signals to different nblocks
+// never contend
+struct alignas(64) NBlock {
+    std::atomic<int> count;
+    NBlock(int n) : count(n) {}
 };
 
-void DestroyNBlock(int);
-int CreateNBlock(int);
-void WaitNBlock(int);
-void SignalNBlock(int);
+// the nblocks of one owner indexed by id, a deque keeps them in place as it
+// grows. ids are never reused while any nblock of the table is alive.
+class NBlockTable {
+    public:
+        NBlockTable();
+        void DestroyNBlock(int);
+        int CreateNBlock(int);
+        bool SignalNBlock(int);
+        bool SignalLocalNBlock(int);
+    private:
+        std::deque<NBlock> nBlocks;
+        int liveNBlocks;
+
+        NBlock* getNBlock(int);
+};
 
 #endif
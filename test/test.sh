@@ -2,6 +2,14 @@
 
 cd "$(dirname "$0")/.."
 
+FAILED=0
+WORK=$(mktemp -d)
+OUTPUT=$WORK/output.txt
+trap "rm -rf $WORK" EXIT
+
+# enough workers for the widest config, so that every node completes at
+# its critical path time whatever the number of cores. options after the
+# config are passed on to every binary
 function runConfig
 {
     echo "Configuration $1:"
@@ -9,14 +17,322 @@ function runConfig
     # run with graph
     echo ""
     echo "Running with graph/graph:"
-    graph/graph $1
+    graph/graph --threads 8 "${@:2}" $1
     # run with nblock
     echo ""
     echo "Running with nblock/nblock:"
-    nblock/nblock $1
+    nblock/nblock --threads 8 "${@:2}" $1
+    echo ""
+    # run with coro
+    echo ""
+    echo "Running with coro/coro:"
+    coro/coro --threads 8 "${@:2}" $1
     echo ""
 }
 
+# nodes that complete at the same time print in any order, so the lines of
+# each run are sorted before they are compared
+function normalize
+{
+    local run=()
+    while IFS= read -r line; do
+        if [[ $line == Node\ * ]]; then
+            run+=("$line")
+            continue
+        fi
+        if [ ${#run[@]} -gt 0 ]; then
+            printf "%s\n" "${run[@]}" | sort
+            run=()
+        fi
+        echo "$line"
+    done
+    if [ ${#run[@]} -gt 0 ]; then
+        printf "%s\n" "${run[@]}" | sort
+    fi
+}
+
+# compare what a check printed with what it should print
+function check
+{
+    if [ "$2" == "$3" ]; then
+        echo "PASS $1"
+    else
+        echo "FAIL $1"
+        diff <(echo "$3") <(echo "$2")
+        FAILED=1
+    fi
+}
+
 for filename in config/*; do
     runConfig $filename
+done | tee $OUTPUT
+check "configs match test/output.txt" "$(normalize < $OUTPUT)" "$(normalize < test/output.txt)"
+check "shared expressions match --no-optimize" "$(graph/graph --threads 8 config/7.txt | normalize)" \
+    "$(graph/graph --threads 8 --no-optimize config/7.txt | normalize)"
+
+# one worker runs B and C one after the other, coro waits out both at once
+ONE_WORKER="Node A computed a value of 1 after 1 second.
+Node B computed a value of 2 after 2 seconds.
+Node C computed a value of 3 after 3 seconds.
+Node D computed a value of 4 after 4 seconds.
+Total computation resulted in a value of 10 after 4 seconds."
+check "graph --threads 1" "$(graph/graph --threads 1 config/2.txt)" "$ONE_WORKER"
+check "nblock --threads 1" "$(nblock/nblock --threads 1 config/2.txt)" "$ONE_WORKER"
+check "coro --threads 1" "$(coro/coro --threads 1 config/2.txt | normalize)" \
+    "$(graph/graph --threads 8 config/2.txt | normalize)"
+
+# a simulated run prints the times of the real one without sleeping, also
+# when a single worker has to run the nodes one after the other
+for filename in config/*; do
+    runConfig $filename --simulate
+done > $WORK/simulated.txt
+check "--simulate matches test/output.txt" "$(normalize < $WORK/simulated.txt)" \
+    "$(normalize < test/output.txt)"
+check "graph --simulate --threads 1" "$(graph/graph --simulate --threads 1 config/2.txt)" \
+    "$ONE_WORKER"
+check "nblock --simulate --threads 1" "$(nblock/nblock --simulate --threads 1 config/2.txt)" \
+    "$ONE_WORKER"
+printf "A 1 3600\nB 2 3600 A\n" > $WORK/hours.txt
+check "--simulate does not sleep" "$(timeout 5 graph/graph --simulate $WORK/hours.txt | tail -1)" \
+    "Total computation resulted in a value of 3 after 7200 seconds."
+# an expression may hold at most 64 operands on its stack at once
+DEEP=$(printf "1 %.0s" $(seq 64); printf "+ %.0s" $(seq 63))
+printf "A 0 0 = %s\n" "$DEEP" > $WORK/deep.txt
+check "64 operands deep" "$(graph/graph $WORK/deep.txt | tail -1)" \
+    "Total computation resulted in a value of 64 after 0 seconds."
+printf "A 0 0 = 1 %s +\n" "$DEEP" > $WORK/deeper.txt
+check "65 operands deep is rejected" "$(graph/graph $WORK/deeper.txt 2>&1 | tail -1)" \
+    "The configuration file could not be parsed."
+
+# zero duration graphs wider than any worker count, generated once
+make -s -C bench gen_dag || exit 1
+bench/gen_dag layered 10000 > $WORK/layered.txt
+bench/gen_dag fanout 5000 > $WORK/fanout.txt
+
+# a small zero duration graph where B and D have expressions and C has none
+printf "A 1 0\nB 0 0 A = V 10 *\nC 3 0 A\nD 0 0 B C = V\n" > $WORK/small.txt
+echo "Q 1 2" > $WORK/unknown.txt
+
+# the stealing and pinned backends compute the same as the shared queue
+for binary in graph/graph nblock/nblock coro/coro; do
+    for config in $WORK/layered.txt $WORK/fanout.txt; do
+        for backend in steal pinned; do
+            check "$binary --scheduler $backend $(basename $config)" \
+                "$($binary --threads 4 --scheduler $backend $config | sort)" \
+                "$($binary --threads 4 $config | sort)"
+        done
+    done
+done
+check "graph --scheduler pinned config/2" \
+    "$(graph/graph --threads 8 --scheduler pinned config/2.txt | normalize)" \
+    "$(graph/graph --threads 8 --simulate config/2.txt | normalize)"
+
+# split over processes a graph computes what it does in one, and nodes
+# still complete at their critical path time across the processes
+for binary in graph/graph nblock/nblock coro/coro; do
+    check "$binary --processes 3" "$($binary --threads 4 --processes 3 $WORK/layered.txt | sort)" \
+        "$($binary --threads 4 $WORK/layered.txt | sort)"
+done
+check "graph --processes 2 config/2" \
+    "$(graph/graph --threads 8 --processes 2 config/2.txt | normalize)" \
+    "$(graph/graph --threads 8 --simulate config/2.txt | normalize)"
+
+# every policy computes the same, and with two workers a real run starts
+# the roots in the order its simulation does. the 5 second D only finishes
+# at 6 seconds if its root C is started before A and B
+printf "A 1 1\nB 2 1\nC 3 1\nD 4 5 C\n" > $WORK/critical.txt
+for binary in graph/graph nblock/nblock coro/coro; do
+    for policy in lifo critical; do
+        check "$binary --policy $policy layered.txt" \
+            "$($binary --threads 4 --policy $policy $WORK/layered.txt | sort)" \
+            "$($binary --threads 4 $WORK/layered.txt | sort)"
+    done
+done
+for binary in graph/graph nblock/nblock; do
+    check "$binary --policy critical" \
+        "$($binary --threads 2 --policy critical $WORK/critical.txt | normalize)" \
+        "$($binary --threads 2 --policy critical --simulate $WORK/critical.txt | normalize)"
 done
+check "graph --policy lifo" "$(graph/graph --threads 2 --policy lifo $WORK/critical.txt | normalize)" \
+    "$(graph/graph --threads 2 --policy lifo --simulate $WORK/critical.txt | normalize)"
+check "--simulate --policy fifo" \
+    "$(graph/graph --threads 2 --simulate $WORK/critical.txt | tail -1)" \
+    "Total computation resulted in a value of 10 after 7 seconds."
+
+# a node named in the vectors file takes its line, C repeats its value in
+# each element and every expression is evaluated element by element
+echo "A 1 2 3" > $WORK/vectors.txt
+VECTORS="Node A computed a value of 6 after 0 seconds.
+Node B computed a value of 60 after 0 seconds.
+Node C computed a value of 9 after 0 seconds.
+Node D computed a value of 69 after 0 seconds.
+Total computation resulted in a value of 144 after 0 seconds."
+for binary in graph/graph nblock/nblock coro/coro; do
+    check "$binary --vectors" \
+        "$($binary --threads 4 --vectors $WORK/vectors.txt $WORK/small.txt | normalize)" \
+        "$(echo "$VECTORS" | normalize)"
+done
+check "--vectors with durations" \
+    "$(graph/graph --threads 8 --vectors $WORK/vectors.txt config/3.txt | normalize)" \
+    "$(echo "Node A computed a value of 6 after 1 second.
+Node B computed a value of 93 after 2 seconds.
+Node C computed a value of 2 after 2 seconds.
+Node D computed a value of 104 after 3 seconds.
+Total computation resulted in a value of 205 after 3 seconds." | normalize)"
+printf "A 1 2 3\nC 1 2\n" > $WORK/uneven.txt
+check "--vectors rejects vectors of different lengths" \
+    "$(graph/graph --vectors $WORK/uneven.txt $WORK/small.txt 2>&1)" \
+    "Node C has 2 scenario values instead of 3."
+check "--vectors rejects unknown nodes" \
+    "$(graph/graph --vectors $WORK/unknown.txt $WORK/small.txt 2>&1)" \
+    "The vectors name nodes that are not in the graph."
+
+# the rows of nodes that complete at the same time come in any order
+for binary in graph/graph nblock/nblock coro/coro; do
+    check "$binary --output csv" "$($binary --output csv $WORK/small.txt | LC_ALL=C sort)" \
+        "A,1,0
+B,10,0
+C,3,0
+D,13,0
+node,value,time
+total,27,0"
+    $binary --output binary $WORK/small.txt > $WORK/output.bin
+    check "$binary --output binary header" "$(od -An -v -t d4 -N 8 $WORK/output.bin)" \
+        "  1414876999           1"
+    check "$binary --output binary rows" \
+        "$(od -An -v -t d4 -j 8 -w12 $WORK/output.bin | tr -s ' ' | LC_ALL=C sort)" \
+        " -1 27 0
+ 0 1 0
+ 1 10 0
+ 2 3 0
+ 3 13 0"
+    check "$binary --output none" "$($binary --output none $WORK/small.txt)" ""
+done
+
+# a batch runs its graphs side by side on one pool, so three graphs of
+# three seconds take three seconds, and a bad graph fails the batch
+for binary in graph/graph nblock/nblock coro/coro; do
+    check "$binary --batch" \
+        "$($binary --threads 8 --batch config/3.txt config/3.txt $WORK/small.txt config/3.txt \
+            | sed 's/ in 3\.[0-9]* seconds.*/ in 3 seconds/')" \
+        "config/3.txt: Total computation resulted in a value of 68 after 3 seconds.
+config/3.txt: Total computation resulted in a value of 68 after 3 seconds.
+$WORK/small.txt: Total computation resulted in a value of 27 after 0 seconds.
+config/3.txt: Total computation resulted in a value of 68 after 3 seconds.
+Ran 4 graphs in 3 seconds"
+done
+check "--batch fails on a bad graph" \
+    "$(timeout 10 graph/graph --batch config/1.txt $WORK/missing.txt > /dev/null 2>&1; echo $?)" "1"
+
+# config/3 for four values of A, the results are the GRES header and the
+# total and duration of each scenario
+echo "A 1 5 7 9" > $WORK/scenarios.txt
+for binary in graph/graph nblock/nblock coro/coro; do
+    $binary --scenarios $WORK/scenarios.txt --scenario-out $WORK/results.bin config/3.txt \
+        > /dev/null
+    check "$binary --scenarios" "$(od -An -v -t d4 $WORK/results.bin | tr -s ' \n' ' ')" \
+        " 1397051975 1 4 68 3 72 3 74 3 76 3 "
+done
+check "--scenarios rejects unknown nodes" \
+    "$(graph/graph --scenarios $WORK/unknown.txt --scenario-out $WORK/results.bin config/3.txt 2>&1)" \
+    "The scenarios name nodes that are not in the graph."
+
+# only the nodes whose value an edit changes are printed again. C has no
+# expression, so a new value of A leaves it alone until it is given one
+printf "set A value 2\nset C expr V 5 +\nset C expr\nset Q value 1\nset B expr V +\n" \
+    > $WORK/edits.txt
+EDITED="Node A computed a value of 1 after 0 seconds.
+Node B computed a value of 10 after 0 seconds.
+Node C computed a value of 3 after 0 seconds.
+Node D computed a value of 13 after 0 seconds.
+Total computation resulted in a value of 27 after 0 seconds.
+Node A computed a value of 2 after 0 seconds.
+Node B computed a value of 20 after 0 seconds.
+Node D computed a value of 23 after 0 seconds.
+Total computation resulted in a value of 48 after 0 seconds.
+Node C computed a value of 7 after 0 seconds.
+Node D computed a value of 27 after 0 seconds.
+Total computation resulted in a value of 56 after 0 seconds.
+Node C computed a value of 3 after 0 seconds.
+Node D computed a value of 23 after 0 seconds.
+Total computation resulted in a value of 48 after 0 seconds.
+Node 'Q' is not in the graph.
+Symbol '+' of node B is missing an operand."
+for binary in graph/graph nblock/nblock coro/coro; do
+    check "$binary --interactive" \
+        "$($binary --threads 4 --interactive $WORK/small.txt < $WORK/edits.txt 2>&1 | normalize)" \
+        "$(echo "$EDITED" | normalize)"
+done
+
+# a compiled graph runs like the config it was compiled from
+for binary in graph/graph nblock/nblock coro/coro; do
+    $binary --compile $WORK/layered.gbin $WORK/layered.txt > /dev/null
+    check "$binary --compile" "$($binary --threads 4 $WORK/layered.gbin | sort)" \
+        "$($binary --threads 4 $WORK/layered.txt | sort)"
+done
+graph/graph --compile $WORK/2.gbin config/2.txt > /dev/null
+check "compiled config/2" "$(graph/graph --threads 8 $WORK/2.gbin | normalize)" \
+    "$(graph/graph --threads 8 config/2.txt | normalize)"
+graph/graph --compile $WORK/small.gbin $WORK/small.txt > /dev/null
+cp $WORK/small.gbin $WORK/unedited.gbin
+check "--interactive on a gbin" \
+    "$(graph/graph --threads 4 --interactive $WORK/small.gbin < $WORK/edits.txt 2>&1 | normalize)" \
+    "$(echo "$EDITED" | normalize)"
+check "--interactive leaves the gbin file alone" "$(cmp $WORK/small.gbin $WORK/unedited.gbin)" ""
+
+# copy chain.gbin to $1.gbin with the bytes $3 written at offset $2
+function patchGbin
+{
+    cp $WORK/chain.gbin $WORK/$1.gbin
+    printf "$3" | dd of=$WORK/$1.gbin bs=1 seek=$2 conv=notrunc status=none
+}
+
+# B depends on A and C on B. the dependencies of the three nodes start after
+# the 64 byte header and five sections of a cache line, the order is last
+printf "A 1 0\nB 2 0 A\nC 3 0 B\n" > $WORK/chain.txt
+graph/graph --compile $WORK/chain.gbin $WORK/chain.txt > /dev/null
+ORDER=$(( $(stat -c %s $WORK/chain.gbin) - 12 ))
+patchGbin cycle 384 '\x02\x00\x00\x00'
+patchGbin badid 384 '\x07\x00\x00\x00'
+patchGbin order $ORDER '\x02\x00\x00\x00\x01\x00\x00\x00\x00\x00\x00\x00'
+head -c 500 $WORK/chain.gbin > $WORK/truncated.gbin
+NOT_PARSED="The configuration file could not be parsed."
+for binary in graph/graph nblock/nblock coro/coro; do
+    check "$binary rejects a cyclic gbin" "$(timeout 10 $binary $WORK/cycle.gbin 2>&1)" \
+        "The dependencies of the configuration file form a cycle.
+$NOT_PARSED"
+    check "$binary rejects a gbin with a bad id" "$(timeout 10 $binary $WORK/badid.gbin 2>&1)" \
+        "The compiled graph has invalid edges.
+$NOT_PARSED"
+    check "$binary rejects a truncated gbin" "$(timeout 10 $binary $WORK/truncated.gbin 2>&1)" \
+        "The compiled graph is truncated or corrupt.
+$NOT_PARSED"
+    check "$binary sorts a gbin with a wrong order" "$(timeout 10 $binary $WORK/order.gbin)" \
+        "$($binary $WORK/chain.txt)"
+done
+
+# a server answers configs and compiled graphs and rejects cyclic ones
+make -s -C bench serve_load || exit 1
+printf "A 1 0 B\nB 2 0 A\n" > $WORK/cycle.txt
+for binary in graph/graph nblock/nblock coro/coro; do
+    rm -f $WORK/serve.sock
+    $binary --threads 4 --serve $WORK/serve.sock > /dev/null 2>&1 &
+    SERVER=$!
+    while [ ! -S $WORK/serve.sock ]; do sleep 0.1; done
+    check "$binary --serve a config" \
+        "$(timeout 10 bench/serve_load $WORK/serve.sock $WORK/small.txt 2 2 | cut -d' ' -f1-6)" \
+        "clients 2 requests 4 failed 0"
+    check "$binary --serve rejects a cyclic config" \
+        "$(timeout 10 bench/serve_load $WORK/serve.sock $WORK/cycle.txt 1 1 | cut -d' ' -f1-6)" \
+        "clients 1 requests 1 failed 1"
+    check "$binary --serve a gbin" \
+        "$(timeout 10 bench/serve_load $WORK/serve.sock $WORK/chain.gbin 2 2 | cut -d' ' -f1-6)" \
+        "clients 2 requests 4 failed 0"
+    check "$binary --serve rejects a cyclic gbin" \
+        "$(timeout 10 bench/serve_load $WORK/serve.sock $WORK/cycle.gbin 1 1 | cut -d' ' -f1-6)" \
+        "clients 1 requests 1 failed 1"
+    kill $SERVER
+    wait $SERVER 2> /dev/null
+done
+
+exit $FAILED